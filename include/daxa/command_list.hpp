@@ -1,13 +1,22 @@
 #pragma once
 
+#include <span>
+
 #include <daxa/core.hpp>
 #include <daxa/gpu_resources.hpp>
 #include <daxa/pipeline.hpp>
+#include <daxa/timeline_query.hpp>
+#include <daxa/query_pool.hpp>
 
 namespace daxa
 {
     struct CommandListInfo
     {
+        // Folds consecutive image barriers on the same subresource into one barrier, instead of recording a layout transition chain.
+        bool fold_image_barriers = false;
+        // Reusable lists can be submitted any number of times after they were completed, also while previous submissions are still pending.
+        // Deferred destructions run once the list is released.
+        bool reusable = false;
         std::string debug_name = {};
     };
 
@@ -33,10 +42,27 @@ namespace daxa
         usize size = {};
     };
 
+    struct BufferCopyRegion
+    {
+        usize src_offset = {};
+        usize dst_offset = {};
+        usize size = {};
+    };
+
+    struct BufferCopiesInfo
+    {
+        BufferId src_buffer = {};
+        BufferId dst_buffer = {};
+        std::span<BufferCopyRegion const> regions = {};
+    };
+
     struct BufferImageCopy
     {
         BufferId buffer = {};
         usize buffer_offset = {};
+        // Texels between the starts of two buffer rows and rows between two buffer images, zero means tightly packed.
+        u32 buffer_row_length = {};
+        u32 buffer_image_height = {};
         ImageId image = {};
         ImageLayout image_layout = {};
         ImageArraySlice image_slice = {};
@@ -44,6 +70,55 @@ namespace daxa
         Extent3D image_extent = {};
     };
 
+    struct BufferImageCopyRegion
+    {
+        usize buffer_offset = {};
+        u32 buffer_row_length = {};
+        u32 buffer_image_height = {};
+        ImageArraySlice image_slice = {};
+        Offset3D image_offset = {};
+        Extent3D image_extent = {};
+    };
+
+    struct BufferImageCopiesInfo
+    {
+        BufferId buffer = {};
+        ImageId image = {};
+        ImageLayout image_layout = {};
+        std::span<BufferImageCopyRegion const> regions = {};
+    };
+
+    struct ImageStagingLayoutInfo
+    {
+        Format format = Format::R8G8B8A8_UNORM;
+        std::array<u32, 3> size = {0, 0, 0};
+        ImageMipArraySlice slice = {};
+        usize base_offset = {};
+        // Rows are padded to a multiple of this many bytes.
+        usize row_pitch_alignment = 1;
+        usize region_alignment = 16;
+    };
+
+    struct ImageStagingRegion
+    {
+        BufferImageCopyRegion copy = {};
+        // Byte distances between two rows of texel blocks, two depth slices and two array layers.
+        usize row_pitch = {};
+        usize depth_pitch = {};
+        usize layer_pitch = {};
+    };
+
+    struct ImageStagingLayout
+    {
+        // One region per mip level, covering all layers of the slice.
+        std::vector<ImageStagingRegion> regions = {};
+        // End of the last region, including base_offset.
+        usize size = {};
+    };
+
+    // Lays out the mips and layers of an image slice in a staging buffer, respecting the texel block size of the format.
+    auto image_staging_layout(ImageStagingLayoutInfo const & info) -> ImageStagingLayout;
+
     struct ImageToBufferInfo
     {
         ImageId image = {};
@@ -68,6 +143,24 @@ namespace daxa
         Extent3D extent = {};
     };
 
+    struct ImageCopyRegion
+    {
+        ImageArraySlice src_slice = {};
+        Offset3D src_offset = {};
+        ImageArraySlice dst_slice = {};
+        Offset3D dst_offset = {};
+        Extent3D extent = {};
+    };
+
+    struct ImageCopiesInfo
+    {
+        ImageId src_image = {};
+        ImageLayout src_image_layout = {};
+        ImageId dst_image = {};
+        ImageLayout dst_image_layout = {};
+        std::span<ImageCopyRegion const> regions = {};
+    };
+
     struct ImageClearInfo
     {
         ImageLayout dst_image_layout = {};
@@ -90,6 +183,16 @@ namespace daxa
         Access waiting_pipeline_access = AccessConsts::NONE;
     };
 
+    struct PipelineBarrierBufferInfo
+    {
+        Access awaited_pipeline_access = AccessConsts::NONE;
+        Access waiting_pipeline_access = AccessConsts::NONE;
+        BufferId buffer = {};
+        usize offset = {};
+        // Zero covers the buffer from offset to its end.
+        usize size = {};
+    };
+
     struct PipelineBarrierImageTransitionInfo
     {
         Access awaited_pipeline_access = AccessConsts::NONE;
@@ -100,6 +203,81 @@ namespace daxa
         ImageMipArraySlice image_slice = {};
     };
 
+    struct AttachmentResolveInfo
+    {
+        ImageViewId image_view = {};
+        ImageLayout layout = ImageLayout::ATTACHMENT_OPTIMAL;
+        // Integer formats only support SAMPLE_ZERO, depth and stencil only the modes reported by the device.
+        ResolveMode mode = ResolveMode::AVERAGE;
+    };
+
+    struct EventSignalInfo
+    {
+        std::span<PipelineBarrierInfo const> barriers = {};
+        std::span<PipelineBarrierBufferInfo const> buffer_barriers = {};
+        std::span<PipelineBarrierImageTransitionInfo const> image_barriers = {};
+    };
+
+    // Identifies a signaled event within the command list that signaled it.
+    struct CommandListEvent
+    {
+        u32 index = {};
+    };
+
+    struct ResetTimestampsInfo
+    {
+        TimelineQueryPool & query_pool;
+        u32 start_index = {};
+        u32 count = {};
+    };
+
+    struct WriteTimestampInfo
+    {
+        TimelineQueryPool & query_pool;
+        u32 query_index = {};
+        PipelineStageFlags pipeline_stage = PipelineStageFlagBits::BOTTOM_OF_PIPE;
+    };
+
+    struct ResetQueriesInfo
+    {
+        QueryPool & query_pool;
+        u32 start_index = {};
+        u32 count = {};
+    };
+
+    struct BeginQueryInfo
+    {
+        QueryPool & query_pool;
+        u32 query_index = {};
+        // Occlusion queries count the exact number of passing samples instead of only reporting non zero, when the device supports it.
+        bool precise = false;
+    };
+
+    struct EndQueryInfo
+    {
+        QueryPool & query_pool;
+        u32 query_index = {};
+    };
+
+    struct CopyQueryResultsInfo
+    {
+        QueryPool & query_pool;
+        u32 start_index = {};
+        u32 count = {};
+        // Receives tightly packed u64 values, laid out like QueryPool::get_query_results when with_availability is set.
+        BufferId dst_buffer = {};
+        usize dst_offset = {};
+        bool with_availability = true;
+        // Waits on the gpu for the queries to become available instead of writing what is currently available.
+        bool wait_for_results = false;
+    };
+
+    // A pair of timestamps in a TimelineQueryPool, see CommandList::begin_gpu_zone.
+    struct GpuZone
+    {
+        u32 query_index = {};
+    };
+
     struct RenderAttachmentInfo
     {
         ImageViewId image_view{};
@@ -107,6 +285,9 @@ namespace daxa
         AttachmentLoadOp load_op = AttachmentLoadOp::DONT_CARE;
         AttachmentStoreOp store_op = AttachmentStoreOp::STORE;
         ClearValue clear_value = {};
+        // Resolves the multisampled attachment into a single sampled image at the end of the render pass.
+        // Combined with store_op DONT_CARE and a TRANSIENT_ATTACHMENT image, the multisampled image never has to be written to memory.
+        std::optional<AttachmentResolveInfo> resolve = {};
     };
 
     struct RenderPassBeginInfo
@@ -115,6 +296,30 @@ namespace daxa
         std::optional<RenderAttachmentInfo> depth_attachment = {};
         std::optional<RenderAttachmentInfo> stencil_attachment = {};
         Rect2D render_area = {};
+        // Number of attachment layers rendered to, ignored when view_mask is not zero.
+        u32 layer_count = 1;
+        // Each set bit broadcasts draws to the attachment layer of the same index (VK_KHR_multiview).
+        // Has to match the view_mask of all pipelines used in the render pass.
+        u32 view_mask = 0;
+        // The render pass content is recorded into secondary command lists, see Device::create_secondary_command_list.
+        // No other commands than execute_secondary_command_lists may be recorded until end_renderpass.
+        bool secondary_command_lists = false;
+    };
+
+    struct SecondaryCommandListInfo
+    {
+        // The render pass the list is executed in. Attachment formats, sample count, view mask and render area are inherited.
+        RenderPassBeginInfo render_pass = {};
+        // Required to execute the list in a reusable primary list.
+        bool reusable = false;
+        std::string debug_name = {};
+    };
+
+    // The buffer holds the three u32 group counts at offset, which must be a multiple of 4.
+    struct DispatchIndirectInfo
+    {
+        BufferId indirect_buffer = {};
+        usize offset = {};
     };
 
     struct DrawInfo
@@ -134,6 +339,7 @@ namespace daxa
         u32 first_instance = 0;
     };
 
+    // A stride of zero means tightly packed draw commands.
     struct DrawIndirectInfo
     {
         BufferId indirect_buffer = {};
@@ -142,6 +348,28 @@ namespace daxa
         u32 stride = {};
     };
 
+    // The number of draws is read from count_buffer at count_buffer_offset and clamped to max_draw_count.
+    struct DrawIndirectCountInfo
+    {
+        BufferId indirect_buffer = {};
+        usize offset = {};
+        BufferId count_buffer = {};
+        usize count_buffer_offset = {};
+        u32 max_draw_count = {};
+        u32 stride = {};
+    };
+
+    // Redundant state changes skipped while recording, reset when the recording begins.
+    struct CommandListStats
+    {
+        u32 skipped_pipeline_binds = {};
+        u32 skipped_descriptor_set_binds = {};
+        u32 skipped_index_buffer_binds = {};
+        u32 skipped_viewport_sets = {};
+        u32 skipped_scissor_sets = {};
+    };
+
+    // Must be recorded on the thread that created it, see Device::create_command_list.
     struct CommandList : ManagedPtr
     {
         CommandList();
@@ -150,13 +378,38 @@ namespace daxa
         void copy_buffer_to_image(BufferImageCopy const & info);
         void copy_image_to_buffer(BufferImageCopy const & info);
         void copy_image_to_image(ImageCopyInfo const & info);
+        // Record all regions with a single copy command.
+        void copy_buffer_to_buffer(BufferCopiesInfo const & info);
+        void copy_buffer_to_image(BufferImageCopiesInfo const & info);
+        void copy_image_to_buffer(BufferImageCopiesInfo const & info);
+        void copy_image_to_image(ImageCopiesInfo const & info);
         void blit_image_to_image(ImageBlitInfo const & info);
 
         void clear_buffer(BufferClearInfo const & info);
         void clear_image(ImageClearInfo const & info);
 
+        // Barriers are batched until the next command that does work. Global barriers of a batch are merged into one.
         void pipeline_barrier(PipelineBarrierInfo const & info);
+        void pipeline_barrier_buffer(PipelineBarrierBufferInfo const & info);
         void pipeline_barrier_image_transition(PipelineBarrierImageTransitionInfo const & info);
+        // Split barrier: the barriers begin once all previously recorded work finished the awaited accesses,
+        // and wait_events blocks the waiting accesses of later work until they completed.
+        // Work recorded between the two calls is not blocked. The event can only be waited on in the same command list.
+        auto signal_event(EventSignalInfo const & info) -> CommandListEvent;
+        void wait_events(std::span<CommandListEvent const> events);
+
+        void reset_timestamps(ResetTimestampsInfo const & info);
+        void write_timestamp(WriteTimestampInfo const & info);
+        // Zones take consecutive query pairs from the start of the pool and are read back with TimelineQueryPool::resolve_gpu_zones.
+        // reset_gpu_zones resets the whole pool and has to be recorded before the first zone of a frame.
+        void reset_gpu_zones(TimelineQueryPool & query_pool);
+        void reset_queries(ResetQueriesInfo const & info);
+        void begin_query(BeginQueryInfo const & info);
+        void end_query(EndQueryInfo const & info);
+        void copy_query_results(CopyQueryResultsInfo const & info);
+        // Zones that do not fit into the pool anymore are not recorded and missing from the resolved zones.
+        auto begin_gpu_zone(TimelineQueryPool & query_pool, std::string_view name) -> GpuZone;
+        void end_gpu_zone(TimelineQueryPool & query_pool, GpuZone const & zone);
 
         void push_constant(void const * data, u32 size, u32 offset = 0);
         template <typename T>
@@ -167,6 +420,7 @@ namespace daxa
         void set_pipeline(ComputePipeline const & pipeline);
         void set_pipeline(RasterPipeline const & pipeline);
         void dispatch(u32 group_x, u32 group_y = 1, u32 group_z = 1);
+        void dispatch_indirect(DispatchIndirectInfo const & info);
 
         void destroy_buffer_deferred(BufferId id);
         void destroy_image_deferred(ImageId id);
@@ -174,6 +428,8 @@ namespace daxa
         void destroy_sampler_deferred(SamplerId id);
 
         void begin_renderpass(RenderPassBeginInfo const & info);
+        // Executes completed secondary command lists in order. They are kept alive until this list is retired.
+        void execute_secondary_command_lists(std::span<CommandList const> secondary_command_lists);
         void end_renderpass();
         void set_viewport(ViewportInfo const & info);
         void set_scissor(Rect2D const & info);
@@ -181,11 +437,17 @@ namespace daxa
         void draw(DrawInfo const & info);
         void draw_indexed(DrawIndexedInfo const & info);
         void draw_indirect(DrawIndirectInfo const & info);
+        void draw_indexed_indirect(DrawIndirectInfo const & info);
+        // Require Device::draw_indirect_count_supported, check it and fall back to draw_indirect with a cpu side draw count otherwise.
+        // Unlike multi draws there is no implicit fallback, the draw count is only known on the gpu.
+        void draw_indirect_count(DrawIndirectCountInfo const & info);
+        void draw_indexed_indirect_count(DrawIndirectCountInfo const & info);
 
         void complete();
         auto is_complete() const -> bool;
 
         auto info() const -> CommandListInfo const &;
+        auto stats() const -> CommandListStats const &;
 
       private:
         friend struct Device;
@@ -129,6 +129,11 @@ namespace daxa
     RWTexture2D<T> get_RWTexture2D(ImageViewId image_id);
     template <typename T>
     RWTexture3D<T> get_RWTexture3D(ImageViewId image_id);
+    template <typename T>
+    RWTexture2DArray<T> get_RWTexture2DArray(ImageViewId image_id);
+
+// Semantic of the view index in multiview render passes, for example: float4 main(uint view_index : DAXA_VIEW_INDEX) : SV_Target
+#define DAXA_VIEW_INDEX SV_ViewID
 
     [[vk::binding(daxa::CONSTANTS::SAMPLER_BINDING, 0)]] SamplerState SamplerStateView[];
     SamplerState get_sampler(SamplerId sampler_id)
@@ -259,6 +264,16 @@ namespace daxa
             return RWTexture3DView##Type[ID_INDEX_MASK & image_id.data];                                      \
         }                                                                                                     \
     }
+#define DAXA_DEFINE_GET_RWTEXTURE2DARRAY(Type)                                                                          \
+    namespace daxa                                                                                                      \
+    {                                                                                                                   \
+        [[vk::binding(daxa::CONSTANTS::STORAGE_IMAGE_BINDING, 0)]] RWTexture2DArray<Type> RWTexture2DArrayView##Type[]; \
+        template <>                                                                                                     \
+        RWTexture2DArray<Type> get_RWTexture2DArray<Type>(ImageViewId image_id)                                         \
+        {                                                                                                               \
+            return RWTexture2DArrayView##Type[ID_INDEX_MASK & image_id.data];                                           \
+        }                                                                                                               \
+    }
 
 DAXA_DEFINE_GET_TEXTURE2D(float)
 DAXA_DEFINE_GET_TEXTURE2D(float2)
@@ -5,6 +5,8 @@
 #include <daxa/gpu_resources.hpp>
 #include <daxa/pipeline.hpp>
 #include <daxa/semaphore.hpp>
+#include <daxa/timeline_query.hpp>
+#include <daxa/query_pool.hpp>
 #include <daxa/swapchain.hpp>
 #include <daxa/command_list.hpp>
 #include <daxa/device.hpp>
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <new>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
 #include <daxa/core.hpp>
 #include <daxa/gpu_resources.hpp>
 #include <daxa/pipeline.hpp>
@@ -178,11 +183,174 @@ namespace daxa
         Swapchain & swapchain;
     };
 
+    struct MemoryToImageCopyInfo
+    {
+        void const * memory_ptr = {};
+        // Texels between the starts of two memory rows and rows between two memory images, zero means tightly packed.
+        u32 memory_row_length = {};
+        u32 memory_image_height = {};
+        ImageId image = {};
+        ImageLayout image_layout = ImageLayout::GENERAL;
+        ImageArraySlice image_slice = {};
+        Offset3D image_offset = {};
+        Extent3D image_extent = {};
+    };
+
+    struct ImageToMemoryCopyInfo
+    {
+        ImageId image = {};
+        ImageLayout image_layout = ImageLayout::GENERAL;
+        ImageArraySlice image_slice = {};
+        Offset3D image_offset = {};
+        Extent3D image_extent = {};
+        void * memory_ptr = {};
+        u32 memory_row_length = {};
+        u32 memory_image_height = {};
+    };
+
+    struct HostImageTransitionInfo
+    {
+        ImageId image = {};
+        ImageLayout before_layout = ImageLayout::UNDEFINED;
+        ImageLayout after_layout = ImageLayout::GENERAL;
+        ImageMipArraySlice image_slice = {};
+    };
+
+    // Move only type erased callable. Callables that fit into the inline storage are not heap allocated.
+    struct DeferredCallback
+    {
+        static inline constexpr usize INLINE_STORAGE_SIZE = 48;
+
+        DeferredCallback() = default;
+
+        template <typename F>
+            requires(!std::same_as<std::remove_cvref_t<F>, DeferredCallback> && std::invocable<std::remove_cvref_t<F> &>)
+        DeferredCallback(F && callable)
+        {
+            using FnT = std::remove_cvref_t<F>;
+            if constexpr (sizeof(FnT) <= INLINE_STORAGE_SIZE && alignof(FnT) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<FnT>)
+            {
+                new (&this->storage) FnT(std::forward<F>(callable));
+                this->vtable = &INLINE_VTABLE<FnT>;
+            }
+            else
+            {
+                *reinterpret_cast<FnT **>(&this->storage) = new FnT(std::forward<F>(callable));
+                this->vtable = &HEAP_VTABLE<FnT>;
+            }
+        }
+
+        DeferredCallback(DeferredCallback && other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        auto operator=(DeferredCallback && other) noexcept -> DeferredCallback &
+        {
+            if (this != &other)
+            {
+                this->reset();
+                if (other.vtable != nullptr)
+                {
+                    other.vtable->move(&other.storage, &this->storage);
+                    this->vtable = std::exchange(other.vtable, nullptr);
+                }
+            }
+            return *this;
+        }
+
+        DeferredCallback(DeferredCallback const &) = delete;
+        auto operator=(DeferredCallback const &) -> DeferredCallback & = delete;
+
+        ~DeferredCallback()
+        {
+            this->reset();
+        }
+
+        void operator()()
+        {
+            DAXA_DBG_ASSERT_TRUE_M(this->vtable != nullptr, "can not invoke empty deferred callback");
+            this->vtable->invoke(&this->storage);
+        }
+
+        explicit operator bool() const
+        {
+            return this->vtable != nullptr;
+        }
+
+        void reset()
+        {
+            if (this->vtable != nullptr)
+            {
+                this->vtable->destroy(&this->storage);
+                this->vtable = nullptr;
+            }
+        }
+
+      private:
+        struct Storage
+        {
+            alignas(std::max_align_t) std::byte bytes[INLINE_STORAGE_SIZE];
+        };
+
+        struct VTable
+        {
+            void (*invoke)(Storage * storage);
+            void (*move)(Storage * src, Storage * dst);
+            void (*destroy)(Storage * storage);
+        };
+
+        template <typename FnT>
+        static inline constexpr VTable INLINE_VTABLE = {
+            .invoke = [](Storage * storage)
+            { (*std::launder(reinterpret_cast<FnT *>(storage)))(); },
+            .move = [](Storage * src, Storage * dst)
+            {
+                FnT * src_fn = std::launder(reinterpret_cast<FnT *>(src));
+                new (dst) FnT(std::move(*src_fn));
+                src_fn->~FnT();
+            },
+            .destroy = [](Storage * storage)
+            { std::launder(reinterpret_cast<FnT *>(storage))->~FnT(); },
+        };
+
+        template <typename FnT>
+        static inline constexpr VTable HEAP_VTABLE = {
+            .invoke = [](Storage * storage)
+            { (**reinterpret_cast<FnT **>(storage))(); },
+            .move = [](Storage * src, Storage * dst)
+            { *reinterpret_cast<FnT **>(dst) = std::exchange(*reinterpret_cast<FnT **>(src), nullptr); },
+            .destroy = [](Storage * storage)
+            { delete *reinterpret_cast<FnT **>(storage); },
+        };
+
+        Storage storage = {};
+        VTable const * vtable = {};
+    };
+
     struct Device : ManagedPtr
     {
         auto create_buffer(BufferInfo const & info) -> BufferId;
+        // Creates the buffer with exportable memory, returning an error when the device does not support exporting it.
+        auto create_exportable_buffer(BufferInfo const & info) -> Result<BufferId>;
+        // Creates a buffer that aliases host memory (for example a memory mapped file) without copying it (VK_EXT_external_memory_host).
+        // Address and size must be aligned to minImportedHostPointerAlignment, which is the page size on most platforms.
+        auto import_host_buffer(ImportHostBufferInfo const & info) -> Result<BufferId>;
+        // Import memory exported by another device or process via export_buffer_fd/export_image_fd.
+        // Both sides must use the same physical device and driver.
+        auto import_buffer_fd(ImportBufferFdInfo const & info) -> Result<BufferId>;
+        auto import_image_fd(ImportImageFdInfo const & info) -> Result<ImageId>;
+        // Returns a new file descriptor owned by the caller. The resource must have been created as exportable.
+        auto export_buffer_fd(BufferId id) -> Result<i32>;
+        auto export_image_fd(ImageId id) -> Result<i32>;
         auto create_image(ImageInfo const & info) -> ImageId;
+        auto create_exportable_image(ImageInfo const & info) -> Result<ImageId>;
         auto create_image_view(ImageViewInfo const & info) -> ImageViewId;
+        // Returns a view matching image, slice, format and type, creating it on first use.
+        // The view is owned by the device and destroyed together with its image, it must not be destroyed manually.
+        auto cached_image_view(ImageViewInfo const & info) -> ImageViewId;
+        // Samplers are deduplicated: identical infos (ignoring the debug name) return the same id.
+        // Every create_sampler call must still be paired with a destroy_sampler call.
         auto create_sampler(SamplerInfo const & info) -> SamplerId;
 
         void destroy_buffer(BufferId id);
@@ -195,17 +363,60 @@ namespace daxa
         auto info_image_view(ImageViewId id) const -> ImageViewInfo;
         auto info_sampler(SamplerId id) const -> SamplerInfo;
 
+        // False once the resource was destroyed, for deferred destructions once the garbage collection destroyed it.
+        auto is_id_valid(BufferId id) const -> bool;
+        auto is_id_valid(ImageId id) const -> bool;
+        auto is_id_valid(ImageViewId id) const -> bool;
+        auto is_id_valid(SamplerId id) const -> bool;
+
         auto create_pipeline_compiler(PipelineCompilerInfo const & info) -> PipelineCompiler;
         auto create_swapchain(SwapchainInfo const & info) -> Swapchain;
+        // Command lists are allocated from pools of the calling thread and must be recorded on that thread.
+        // Completed lists can be submitted from any thread.
         auto create_command_list(CommandListInfo const & info) -> CommandList;
+        // Secondary command lists record draws of one render pass in parallel, each thread recording its own list.
+        // They are executed by the primary list with execute_secondary_command_lists and can not be submitted directly.
+        // Deferred destructions recorded into them run once the list is released.
+        auto create_secondary_command_list(SecondaryCommandListInfo const & info) -> CommandList;
         auto create_binary_semaphore(BinarySemaphoreInfo const & info) -> BinarySemaphore;
         auto create_timeline_semaphore(TimelineSemaphoreInfo const & info) -> TimelineSemaphore;
+        auto create_exportable_timeline_semaphore(TimelineSemaphoreInfo const & info) -> Result<TimelineSemaphore>;
+        auto import_timeline_semaphore_fd(ImportTimelineSemaphoreFdInfo const & info) -> Result<TimelineSemaphore>;
+        auto create_timeline_query_pool(TimelineQueryPoolInfo const & info) -> TimelineQueryPool;
+        // Fails for pipeline statistics pools without Device::pipeline_statistics_query_supported.
+        auto create_query_pool(QueryPoolInfo const & info) -> Result<QueryPool>;
 
         auto map_memory(BufferId id) -> void *;
         void unmap_memory(BufferId id);
+        // Returns the persistent mapping of a buffer created with MemoryFlagBits::MAPPED, or nullptr if the memory is not host visible.
+        // Buffers created with HOST_ACCESS_SEQUENTIAL_WRITE | HOST_ACCESS_ALLOW_TRANSFER_INSTEAD | MAPPED prefer device local host visible memory (resizable bar).
+        // When that is not available they are placed in device local memory and this returns nullptr, so uploads have to go through a staging buffer.
+        auto buffer_host_address(BufferId id) const -> void *;
+        // Returns the mapping and the driver chosen pitches of a mapped ImageTiling::LINEAR image.
+        // Non coherent memory is invalidated, so call this after the timeline passed the last gpu write and before reading.
+        auto image_host_layout(ImageId id) const -> ImageHostLayout;
         auto info() const -> DeviceInfo const &;
         auto properties() const -> DeviceProperties const &;
         void wait_idle();
+
+        // Copies between host memory and images created with ImageUsageFlagBits::HOST_TRANSFER without a staging buffer (VK_EXT_host_image_copy).
+        // The image has to be in image_layout, GENERAL is always supported. Any gpu work accessing the image must have finished.
+        // Without the extension the copy goes through a staging buffer on the main queue and the call blocks until it finished.
+        // Such copies are limited to 4 GiB, larger copies are not performed.
+        void copy_memory_to_image(MemoryToImageCopyInfo const & info);
+        void copy_image_to_memory(ImageToMemoryCopyInfo const & info);
+        // Transitions the layout of a HOST_TRANSFER image on the host, for example from UNDEFINED to GENERAL before the first copy.
+        // Falls back to a blocking main queue barrier like the copies above.
+        void transition_image_layout(HostImageTransitionInfo const & info);
+        auto host_image_copy_supported() const -> bool;
+        // Optional query features, enabled when the device supports them.
+        auto pipeline_statistics_query_supported() const -> bool;
+        auto occlusion_query_precise_supported() const -> bool;
+        // Timeline query pools and gpu zones require timestamp support on the main queue.
+        auto timestamp_query_supported() const -> bool;
+        // Without multiDrawIndirect support, multi draws are split into one indirect draw per command.
+        auto multi_draw_indirect_supported() const -> bool;
+        auto draw_indirect_count_supported() const -> bool;
         template <typename T>
         auto map_memory_as(BufferId id) -> T *
         {
@@ -216,6 +427,11 @@ namespace daxa
         void present_frame(PresentInfo const & info);
         void collect_garbage();
 
+        // Returns the main queue timeline value of the latest submission.
+        auto main_queue_timeline_value() const -> u64;
+        // The callback is invoked by collect_garbage once the gpu finished all main queue submissions up to and including timeline_value.
+        void defer_until_retired(DeferredCallback && callback, u64 timeline_value);
+
       private:
         friend struct Context;
         Device(ManagedPtr impl);
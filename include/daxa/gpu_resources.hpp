@@ -16,6 +16,9 @@ namespace daxa
     {
         MemoryFlags memory_flags = {};
         u32 size = {};
+        // Allocates dedicated memory that can be exported as an opaque posix file descriptor (VK_KHR_external_memory_fd).
+        // Use Device::create_exportable_* to handle devices without support.
+        bool exportable = false;
         std::string debug_name = {};
     };
 
@@ -23,6 +26,22 @@ namespace daxa
     {
     };
 
+    struct ImportBufferFdInfo
+    {
+        // Ownership of the file descriptor is transferred to the device on success.
+        i32 fd = -1;
+        // Must match the info of the exported buffer.
+        BufferInfo info = {};
+    };
+
+    struct ImportHostBufferInfo
+    {
+        // Must stay valid until the buffer is destroyed and its destruction retired on the gpu.
+        void * host_address = {};
+        usize size = {};
+        std::string debug_name = {};
+    };
+
     struct ImageInfo
     {
         u32 dimensions = 2;
@@ -33,7 +52,12 @@ namespace daxa
         u32 array_layer_count = 1;
         u32 sample_count = 1;
         ImageUsageFlags usage = {};
+        ImageTiling tiling = ImageTiling::OPTIMAL;
+        // Linear images created with HOST_ACCESS_SEQUENTIAL_WRITE or HOST_ACCESS_RANDOM and MAPPED are persistently mapped.
         MemoryFlags memory_flags = {};
+        // Allocates dedicated memory that can be exported as an opaque posix file descriptor (VK_KHR_external_memory_fd).
+        // Use Device::create_exportable_* to handle devices without support.
+        bool exportable = false;
         std::string debug_name = {};
     };
 
@@ -44,6 +68,22 @@ namespace daxa
         auto default_view() const -> ImageViewId;
     };
 
+    struct ImportImageFdInfo
+    {
+        // Ownership of the file descriptor is transferred to the device on success.
+        i32 fd = -1;
+        // Must match the info of the exported image.
+        ImageInfo info = {};
+    };
+
+    struct ImageHostLayout
+    {
+        // Points to the first texel, nullptr if the image is not mapped.
+        void * host_address = {};
+        usize size = {};
+        usize row_pitch = {};
+    };
+
     struct ImageViewInfo
     {
         ImageViewType type = ImageViewType::REGULAR_2D;
@@ -84,6 +84,10 @@ namespace daxa
         std::vector<RenderAttachment> color_attachments = {};
         DepthTestInfo depth_test = {};
         RasterizerInfo raster = {};
+        // Has to match the sample count of all attachments.
+        u32 sample_count = 1;
+        // Has to match RenderPassBeginInfo::view_mask, shaders read the current view through DAXA_VIEW_INDEX.
+        u32 view_mask = 0;
         u32 push_constant_size = {};
         std::string debug_name = {};
     };
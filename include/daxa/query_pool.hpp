@@ -0,0 +1,54 @@
+#pragma once
+
+#include <daxa/core.hpp>
+
+namespace daxa
+{
+    enum struct QueryType
+    {
+        OCCLUSION,
+        PIPELINE_STATISTICS,
+    };
+
+    using PipelineStatisticFlags = u32;
+    struct PipelineStatisticFlagBits
+    {
+        static inline constexpr PipelineStatisticFlags NONE = 0x00000000;
+        static inline constexpr PipelineStatisticFlags INPUT_ASSEMBLY_VERTICES = 0x00000001;
+        static inline constexpr PipelineStatisticFlags INPUT_ASSEMBLY_PRIMITIVES = 0x00000002;
+        static inline constexpr PipelineStatisticFlags VERTEX_SHADER_INVOCATIONS = 0x00000004;
+        static inline constexpr PipelineStatisticFlags GEOMETRY_SHADER_INVOCATIONS = 0x00000008;
+        static inline constexpr PipelineStatisticFlags GEOMETRY_SHADER_PRIMITIVES = 0x00000010;
+        static inline constexpr PipelineStatisticFlags CLIPPING_INVOCATIONS = 0x00000020;
+        static inline constexpr PipelineStatisticFlags CLIPPING_PRIMITIVES = 0x00000040;
+        static inline constexpr PipelineStatisticFlags FRAGMENT_SHADER_INVOCATIONS = 0x00000080;
+        static inline constexpr PipelineStatisticFlags TESSELLATION_CONTROL_SHADER_PATCHES = 0x00000100;
+        static inline constexpr PipelineStatisticFlags TESSELLATION_EVALUATION_SHADER_INVOCATIONS = 0x00000200;
+        static inline constexpr PipelineStatisticFlags COMPUTE_SHADER_INVOCATIONS = 0x00000400;
+    };
+
+    struct QueryPoolInfo
+    {
+        QueryType type = QueryType::OCCLUSION;
+        // Only used by PIPELINE_STATISTICS pools. Each query yields one value per set bit, in bit order.
+        PipelineStatisticFlags pipeline_statistics = PipelineStatisticFlagBits::NONE;
+        u32 query_count = {};
+        std::string debug_name = {};
+    };
+
+    // Pool of occlusion or pipeline statistics queries, recorded with CommandList::begin_query and end_query.
+    // Queries have to be reset before they are begun, see CommandList::reset_queries.
+    struct QueryPool : ManagedPtr
+    {
+        auto info() const -> QueryPoolInfo const &;
+
+        // Number of values each query yields: 1 for occlusion queries, the number of statistics otherwise.
+        auto values_per_query() const -> u32;
+        // Does not block. Returns the values of each query followed by its availability, the values are only valid when availability is not zero.
+        auto get_query_results(u32 start_index, u32 count) -> std::vector<u64>;
+
+      private:
+        friend struct Device;
+        QueryPool(ManagedPtr impl);
+    };
+} // namespace daxa
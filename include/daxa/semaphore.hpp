@@ -21,9 +21,18 @@ namespace daxa
     struct TimelineSemaphoreInfo
     {
         u64 initial_value = {};
+        // Makes the semaphore exportable as an opaque posix file descriptor (VK_KHR_external_semaphore_fd).
+        bool exportable = false;
         std::string debug_name = {};
     };
 
+    struct ImportTimelineSemaphoreFdInfo
+    {
+        // Ownership of the file descriptor is transferred to the device on success.
+        i32 fd = -1;
+        TimelineSemaphoreInfo info = {};
+    };
+
     struct TimelineSemaphore : ManagedPtr
     {
         auto info() const -> TimelineSemaphoreInfo const &;
@@ -31,6 +40,8 @@ namespace daxa
         auto value() const -> u64;
         void set_value(u64 value);
         auto wait_for_value(u64 value, u64 timeout_nanos = ~0ull) -> bool;
+        // Returns a new file descriptor owned by the caller.
+        auto export_fd() const -> Result<i32>;
 
       private:
         friend struct Device;
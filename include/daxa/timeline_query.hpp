@@ -0,0 +1,40 @@
+#pragma once
+
+#include <span>
+#include <functional>
+
+#include <daxa/core.hpp>
+
+namespace daxa
+{
+    struct TimelineQueryPoolInfo
+    {
+        u32 query_count = {};
+        std::string debug_name = {};
+    };
+
+    struct GpuZoneResult
+    {
+        std::string name = {};
+        f64 milliseconds = {};
+    };
+
+    using GpuZoneCallback = std::function<void(std::span<GpuZoneResult const>)>;
+
+    // Pool of timestamp queries. Queries have to be reset before they are written, see CommandList::reset_timestamps.
+    struct TimelineQueryPool : ManagedPtr
+    {
+        auto info() const -> TimelineQueryPoolInfo const &;
+
+        // Does not block. Returns a (timestamp, availability) pair for each query, the timestamp is only valid when availability is not zero.
+        auto get_query_results(u32 start_index, u32 count) -> std::vector<u64>;
+        // Reads back the zones recorded since the last reset_gpu_zones once the main queue timeline reached timeline_value.
+        // The callback is invoked by Device::collect_garbage. The pool must not be reset before then,
+        // so use one pool per frame in flight. Requires Device::timestamp_query_supported.
+        void resolve_gpu_zones(u64 timeline_value, GpuZoneCallback callback);
+
+      private:
+        friend struct Device;
+        TimelineQueryPool(ManagedPtr impl);
+    };
+} // namespace daxa
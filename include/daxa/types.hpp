@@ -435,6 +435,16 @@ namespace daxa
         PVRTC2_4BPP_SRGB_BLOCK_IMG = 1000054007,
     };
 
+    struct TexelBlockInfo
+    {
+        u32 extent_x = 1;
+        u32 extent_y = 1;
+        // Zero for formats that are not addressed in texel blocks, like multi-planar formats.
+        u32 byte_size = {};
+    };
+
+    auto texel_block_info(Format format) -> TexelBlockInfo;
+
     enum struct MsgSeverity
     {
         VERBOSE = 0x00000001,
@@ -480,19 +490,24 @@ namespace daxa
         static inline constexpr ImageUsageFlags SHADER_READ_WRITE = 0x00000008;
         static inline constexpr ImageUsageFlags COLOR_ATTACHMENT = 0x00000010;
         static inline constexpr ImageUsageFlags DEPTH_STENCIL_ATTACHMENT = 0x00000020;
+        // Only valid together with attachment usages. Uses lazily allocated memory when the device has it.
         static inline constexpr ImageUsageFlags TRANSIENT_ATTACHMENT = 0x00000040;
         static inline constexpr ImageUsageFlags FRAGMENT_DENSITY_MAP = 0x00000200;
         static inline constexpr ImageUsageFlags FRAGMENT_SHADING_RATE_ATTACHMENT = 0x00000100;
         static inline constexpr ImageUsageFlags SHADING_RATE_IMAGE = FRAGMENT_SHADING_RATE_ATTACHMENT;
+        // Allows Device::copy_memory_to_image and copy_image_to_memory to copy on the host (VK_EXT_host_image_copy).
+        static inline constexpr ImageUsageFlags HOST_TRANSFER = 0x00400000;
     };
 
     using MemoryFlags = u32;
     struct MemoryFlagBits
     {
         static inline constexpr MemoryFlags DEDICATED_MEMORY = 0x00000001;
+        static inline constexpr MemoryFlags MAPPED = 0x00000004;
         static inline constexpr MemoryFlags CAN_ALIAS = 0x00000200;
         static inline constexpr MemoryFlags HOST_ACCESS_SEQUENTIAL_WRITE = 0x00000400;
         static inline constexpr MemoryFlags HOST_ACCESS_RANDOM = 0x00000800;
+        static inline constexpr MemoryFlags HOST_ACCESS_ALLOW_TRANSFER_INSTEAD = 0x00001000;
         static inline constexpr MemoryFlags STRATEGY_MIN_MEMORY = 0x00010000;
         static inline constexpr MemoryFlags STRATEGY_MIN_TIME = 0x00020000;
     };
@@ -530,6 +545,14 @@ namespace daxa
         CUBE_ARRAY = 6,
     };
 
+    enum struct ImageTiling
+    {
+        OPTIMAL = 0,
+        // Row major texel layout that can be accessed by the host in place, see Device::image_host_layout.
+        // Only supported for single sampled 2d images with one mip and layer, and only for a subset of formats and usages.
+        LINEAR = 1,
+    };
+
     using ImageAspectFlags = u32;
     struct ImageAspectFlagBits
     {
@@ -879,6 +902,15 @@ namespace daxa
         DONT_CARE = 1,
     };
 
+    enum struct ResolveMode
+    {
+        NONE = 0,
+        SAMPLE_ZERO = 0x00000001,
+        AVERAGE = 0x00000002,
+        MIN = 0x00000004,
+        MAX = 0x00000008,
+    };
+
     struct ViewportInfo
     {
         f32 x = {};
@@ -887,6 +919,8 @@ namespace daxa
         f32 height = {};
         f32 min_depth = {};
         f32 max_depth = {};
+
+        friend auto operator<=>(ViewportInfo const &, ViewportInfo const &) = default;
     };
 
     struct Rect2D
@@ -895,5 +929,7 @@ namespace daxa
         i32 y = {};
         u32 width = {};
         u32 height = {};
+
+        friend auto operator<=>(Rect2D const &, Rect2D const &) = default;
     };
 } // namespace daxa
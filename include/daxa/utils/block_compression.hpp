@@ -0,0 +1,64 @@
+#pragma once
+
+#if !DAXA_BUILT_WITH_UTILS
+#error "[package management error] You must build Daxa with the UTILS option enabled"
+#endif
+
+#include <daxa/core.hpp>
+#include <daxa/device.hpp>
+
+#include <daxa/utils/task_list.hpp>
+
+namespace daxa
+{
+    enum struct BlockCompressionQuality
+    {
+        // Inset bounding box endpoints.
+        FAST,
+        // One least squares endpoint refinement.
+        BALANCED,
+        // Three least squares endpoint refinements.
+        HIGH,
+    };
+
+    struct BlockCompressorInfo
+    {
+        Device device;
+        PipelineCompiler pipeline_compiler;
+        std::string debug_name = {};
+    };
+
+    struct BlockCompressInfo
+    {
+        // The source has to be readable by compute shaders in src_image_layout.
+        ImageId src_image = {};
+        ImageLayout src_image_layout = ImageLayout::SHADER_READ_ONLY_OPTIMAL;
+        // dst_image has to be created with one of the supported block formats, TRANSFER_DST usage and the same extent as src_image.
+        ImageId dst_image = {};
+        ImageLayout dst_before_layout = ImageLayout::UNDEFINED;
+        ImageLayout dst_after_layout = ImageLayout::SHADER_READ_ONLY_OPTIMAL;
+        // Mips and layers encoded, the same slice is read from src_image and written to dst_image.
+        ImageMipArraySlice slice = {};
+        BlockCompressionQuality quality = BlockCompressionQuality::BALANCED;
+    };
+
+    struct BlockCompressTaskInfo
+    {
+        TaskImageId src_image = {};
+        TaskImageId dst_image = {};
+        ImageMipArraySlice slice = {};
+        BlockCompressionQuality quality = BlockCompressionQuality::BALANCED;
+        std::string debug_name = {};
+    };
+
+    // Encodes uncompressed images into BC1 (opaque), BC4, BC5 or BC7 (mode 6) images with a compute shader.
+    // The blocks are written into a scratch buffer and copied into the destination image.
+    struct BlockCompressor : ManagedPtr
+    {
+        BlockCompressor(BlockCompressorInfo const & info);
+        ~BlockCompressor();
+
+        void record_commands(CommandList & cmd_list, BlockCompressInfo const & info);
+        void record_task(TaskList & task_list, BlockCompressTaskInfo const & info);
+    };
+} // namespace daxa
@@ -0,0 +1,60 @@
+#pragma once
+
+#if !DAXA_BUILT_WITH_UTILS
+#error "[package management error] You must build Daxa with the UTILS option enabled"
+#endif
+
+#include <daxa/core.hpp>
+#include <daxa/device.hpp>
+
+#include <daxa/utils/task_list.hpp>
+
+namespace daxa
+{
+    enum struct MipMapReduction
+    {
+        AVERAGE,
+        MIN,
+        MAX,
+    };
+
+    struct MipMapGeneratorInfo
+    {
+        Device device;
+        PipelineCompiler pipeline_compiler;
+        std::string debug_name = {};
+    };
+
+    struct MipMapGenerateInfo
+    {
+        ImageId image = {};
+        // All mips of the generated layers are expected to be in before_layout and are left in after_layout.
+        ImageLayout before_layout = ImageLayout::GENERAL;
+        ImageLayout after_layout = ImageLayout::GENERAL;
+        u32 base_array_layer = 0;
+        u32 layer_count = 1;
+        MipMapReduction reduction = MipMapReduction::AVERAGE;
+    };
+
+    struct MipMapTaskInfo
+    {
+        TaskImageId image = {};
+        u32 base_array_layer = 0;
+        u32 layer_count = 1;
+        MipMapReduction reduction = MipMapReduction::AVERAGE;
+        std::string debug_name = {};
+    };
+
+    // Generates the full mip chain of 2d images from mip 0.
+    // Images with SHADER_READ_ONLY and SHADER_READ_WRITE usage are reduced by a single pass compute shader,
+    // which writes up to 12 mips per dispatch. All other images fall back to a chain of linear blits,
+    // which only supports MipMapReduction::AVERAGE.
+    struct MipMapGenerator : ManagedPtr
+    {
+        MipMapGenerator(MipMapGeneratorInfo const & info);
+        ~MipMapGenerator();
+
+        void record_commands(CommandList & cmd_list, MipMapGenerateInfo const & info);
+        void record_task(TaskList & task_list, MipMapTaskInfo const & info);
+    };
+} // namespace daxa
@@ -37,6 +37,8 @@ namespace daxa
         TRANSFER_WRITE,
         HOST_TRANSFER_READ,
         HOST_TRANSFER_WRITE,
+        // Indirect dispatch and draw arguments, including draw counts.
+        INDIRECT_COMMAND_READ,
     };
 
     auto to_string(TaskBufferAccess const & usage) -> std::string_view;
@@ -206,6 +208,9 @@ namespace daxa
         auto last_access(TaskBufferId buffer) -> Access;
         auto last_access(TaskImageId image) -> Access;
         auto last_layout(TaskImageId image) -> ImageLayout;
+        // Usage flags required by all recorded accesses of the image, meant to be used in its fetch callback.
+        // Contains TRANSIENT_ATTACHMENT when the image is only used as an attachment and starts with an UNDEFINED layout.
+        auto image_usage(TaskImageId image) -> ImageUsageFlags;
 
         void execute();
 
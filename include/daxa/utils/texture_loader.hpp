@@ -0,0 +1,28 @@
+#pragma once
+
+#if !DAXA_BUILT_WITH_UTILS
+#error "[package management error] You must build Daxa with the UTILS option enabled"
+#endif
+
+#include <daxa/core.hpp>
+#include <daxa/device.hpp>
+
+#include <filesystem>
+
+namespace daxa
+{
+    struct TextureLoadInfo
+    {
+        std::filesystem::path path = {};
+        ImageUsageFlags usage = ImageUsageFlagBits::SHADER_READ_ONLY;
+        // All mips and layers of the created image are left in this layout.
+        ImageLayout final_layout = ImageLayout::SHADER_READ_ONLY_OPTIMAL;
+        std::string debug_name = {};
+    };
+
+    // Loads KTX2 and DDS files. The file is memory-mapped and its payload, usually block compressed, is copied
+    // into a staging buffer as is, without decoding. The image is created with the file's format and all of its mips
+    // and array layers. cmd_list receives the upload commands and owns the staging buffer until the list is retired.
+    // Supercompressed KTX2 files and 3d textures are rejected.
+    auto load_texture(Device & device, CommandList & cmd_list, TextureLoadInfo const & info) -> Result<ImageId>;
+} // namespace daxa
@@ -2,6 +2,7 @@
 #include "impl_device.hpp"
 
 #include <iostream>
+#include <numeric>
 
 namespace daxa
 {
@@ -9,124 +10,254 @@ namespace daxa
 
     void CommandList::copy_buffer_to_buffer(BufferCopyInfo const & info)
     {
-        auto & impl = *as<ImplCommandList>();
-        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
-        impl.flush_barriers();
-
-        VkBufferCopy vk_buffer_copy{
-            .srcOffset = info.src_offset,
-            .dstOffset = info.dst_offset,
+        BufferCopyRegion const region = {
+            .src_offset = info.src_offset,
+            .dst_offset = info.dst_offset,
             .size = info.size,
         };
+        copy_buffer_to_buffer(BufferCopiesInfo{
+            .src_buffer = info.src_buffer,
+            .dst_buffer = info.dst_buffer,
+            .regions = {&region, 1},
+        });
+    }
+
+    void CommandList::copy_buffer_to_image(BufferImageCopy const & info)
+    {
+        BufferImageCopyRegion const region = {
+            .buffer_offset = info.buffer_offset,
+            .buffer_row_length = info.buffer_row_length,
+            .buffer_image_height = info.buffer_image_height,
+            .image_slice = info.image_slice,
+            .image_offset = info.image_offset,
+            .image_extent = info.image_extent,
+        };
+        copy_buffer_to_image(BufferImageCopiesInfo{
+            .buffer = info.buffer,
+            .image = info.image,
+            .image_layout = info.image_layout,
+            .regions = {&region, 1},
+        });
+    }
+
+    void CommandList::copy_image_to_buffer(BufferImageCopy const & info)
+    {
+        BufferImageCopyRegion const region = {
+            .buffer_offset = info.buffer_offset,
+            .buffer_row_length = info.buffer_row_length,
+            .buffer_image_height = info.buffer_image_height,
+            .image_slice = info.image_slice,
+            .image_offset = info.image_offset,
+            .image_extent = info.image_extent,
+        };
+        copy_image_to_buffer(BufferImageCopiesInfo{
+            .buffer = info.buffer,
+            .image = info.image,
+            .image_layout = info.image_layout,
+            .regions = {&region, 1},
+        });
+    }
+
+    static auto to_vk_buffer_image_copies(std::span<BufferImageCopyRegion const> regions) -> std::vector<VkBufferImageCopy>
+    {
+        std::vector<VkBufferImageCopy> vk_buffer_image_copies = {};
+        vk_buffer_image_copies.reserve(regions.size());
+        for (auto const & region : regions)
+        {
+            vk_buffer_image_copies.push_back(VkBufferImageCopy{
+                .bufferOffset = region.buffer_offset,
+                .bufferRowLength = region.buffer_row_length,
+                .bufferImageHeight = region.buffer_image_height,
+                .imageSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&region.image_slice),
+                .imageOffset = *reinterpret_cast<VkOffset3D const *>(&region.image_offset),
+                .imageExtent = *reinterpret_cast<VkExtent3D const *>(&region.image_extent),
+            });
+        }
+        return vk_buffer_image_copies;
+    }
+
+    void CommandList::copy_buffer_to_buffer(BufferCopiesInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "copies can not be recorded inside a render pass");
+        DAXA_DBG_ASSERT_TRUE_M(!info.regions.empty(), "copy requires at least one region");
+        impl.flush_barriers();
 
+        static_assert(sizeof(BufferCopyRegion) == sizeof(VkBufferCopy));
         vkCmdCopyBuffer(
             impl.vk_cmd_buffer,
             impl.impl_device.as<ImplDevice>()->slot(info.src_buffer).vk_buffer,
             impl.impl_device.as<ImplDevice>()->slot(info.dst_buffer).vk_buffer,
-            1,
-            &vk_buffer_copy);
+            static_cast<u32>(info.regions.size()),
+            reinterpret_cast<VkBufferCopy const *>(info.regions.data()));
     }
 
-    void CommandList::copy_buffer_to_image(BufferImageCopy const & info)
+    void CommandList::copy_buffer_to_image(BufferImageCopiesInfo const & info)
     {
         auto & impl = *as<ImplCommandList>();
-        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "copies can not be recorded inside a render pass");
+        DAXA_DBG_ASSERT_TRUE_M(!info.regions.empty(), "copy requires at least one region");
         impl.flush_barriers();
 
-        VkBufferImageCopy vk_buffer_image_copy{
-            .bufferOffset = info.buffer_offset,
-            .bufferRowLength = static_cast<u32>(info.image_extent.x * info.image_extent.z),
-            .bufferImageHeight = static_cast<u32>(info.image_extent.y),
-            .imageSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&info.image_slice),
-            .imageOffset = *reinterpret_cast<VkOffset3D const *>(&info.image_offset),
-            .imageExtent = *reinterpret_cast<VkExtent3D const *>(&info.image_extent),
-        };
-
+        auto const vk_buffer_image_copies = to_vk_buffer_image_copies(info.regions);
         vkCmdCopyBufferToImage(
             impl.vk_cmd_buffer,
             impl.impl_device.as<ImplDevice>()->slot(info.buffer).vk_buffer,
             impl.impl_device.as<ImplDevice>()->slot(info.image).vk_image,
             static_cast<VkImageLayout>(info.image_layout),
-            1,
-            &vk_buffer_image_copy);
+            static_cast<u32>(vk_buffer_image_copies.size()),
+            vk_buffer_image_copies.data());
     }
 
-    void CommandList::copy_image_to_buffer(BufferImageCopy const & info)
+    void CommandList::copy_image_to_buffer(BufferImageCopiesInfo const & info)
     {
         auto & impl = *as<ImplCommandList>();
-        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "copies can not be recorded inside a render pass");
+        DAXA_DBG_ASSERT_TRUE_M(!info.regions.empty(), "copy requires at least one region");
         impl.flush_barriers();
 
-        VkBufferImageCopy vk_buffer_image_copy{
-            .bufferOffset = info.buffer_offset,
-            .bufferRowLength = static_cast<u32>(info.image_extent.x * info.image_extent.y * info.image_extent.z),
-            .bufferImageHeight = 1u,
-            .imageSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&info.image_slice),
-            .imageOffset = *reinterpret_cast<VkOffset3D const *>(&info.image_offset),
-            .imageExtent = *reinterpret_cast<VkExtent3D const *>(&info.image_extent),
-        };
-
+        auto const vk_buffer_image_copies = to_vk_buffer_image_copies(info.regions);
         vkCmdCopyImageToBuffer(
             impl.vk_cmd_buffer,
             impl.impl_device.as<ImplDevice>()->slot(info.image).vk_image,
             static_cast<VkImageLayout>(info.image_layout),
             impl.impl_device.as<ImplDevice>()->slot(info.buffer).vk_buffer,
-            1,
-            &vk_buffer_image_copy);
+            static_cast<u32>(vk_buffer_image_copies.size()),
+            vk_buffer_image_copies.data());
     }
 
-    void CommandList::blit_image_to_image(ImageBlitInfo const & info)
+    void CommandList::copy_image_to_image(ImageCopiesInfo const & info)
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "copies can not be recorded inside a render pass");
+        DAXA_DBG_ASSERT_TRUE_M(!info.regions.empty(), "copy requires at least one region");
         impl.flush_barriers();
 
-        VkImageBlit vk_blit{
-            .srcSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&info.src_slice),
-            .srcOffsets = {*reinterpret_cast<VkOffset3D const *>(&info.src_offsets[0]), *reinterpret_cast<VkOffset3D const *>(&info.src_offsets[1])},
-            .dstSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&info.dst_slice),
-            .dstOffsets = {*reinterpret_cast<VkOffset3D const *>(&info.dst_offsets[0]), *reinterpret_cast<VkOffset3D const *>(&info.dst_offsets[1])},
-        };
-
-        vkCmdBlitImage(
+        std::vector<VkImageCopy> vk_image_copies = {};
+        vk_image_copies.reserve(info.regions.size());
+        for (auto const & region : info.regions)
+        {
+            vk_image_copies.push_back(VkImageCopy{
+                .srcSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&region.src_slice),
+                .srcOffset = *reinterpret_cast<VkOffset3D const *>(&region.src_offset),
+                .dstSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&region.dst_slice),
+                .dstOffset = *reinterpret_cast<VkOffset3D const *>(&region.dst_offset),
+                .extent = *reinterpret_cast<VkExtent3D const *>(&region.extent),
+            });
+        }
+        vkCmdCopyImage(
             impl.vk_cmd_buffer,
             impl.impl_device.as<ImplDevice>()->slot(info.src_image).vk_image,
             static_cast<VkImageLayout>(info.src_image_layout),
             impl.impl_device.as<ImplDevice>()->slot(info.dst_image).vk_image,
             static_cast<VkImageLayout>(info.dst_image_layout),
-            1,
-            &vk_blit,
-            static_cast<VkFilter>(info.filter));
+            static_cast<u32>(vk_image_copies.size()),
+            vk_image_copies.data());
     }
 
-    void CommandList::copy_image_to_image(ImageCopyInfo const & info)
+    auto image_staging_layout(ImageStagingLayoutInfo const & info) -> ImageStagingLayout
+    {
+        TexelBlockInfo const block = texel_block_info(info.format);
+        DAXA_DBG_ASSERT_TRUE_M(block.byte_size != 0, "staging layouts require a format with a known texel block size");
+        usize const block_size = block.byte_size;
+        // Buffer offsets of image copies have to be multiples of the texel block size and of 4.
+        usize const region_alignment = std::lcm(std::lcm(std::max(info.region_alignment, usize{1}), block_size), usize{4});
+        usize const row_alignment = std::lcm(std::max(info.row_pitch_alignment, usize{1}), block_size);
+        ImageStagingLayout layout = {};
+        usize offset = info.base_offset;
+        for (u32 mip = info.slice.base_mip_level; mip < info.slice.base_mip_level + info.slice.level_count; ++mip)
+        {
+            u32 const size_x = std::max(info.size[0] >> mip, 1u);
+            u32 const size_y = std::max(info.size[1] >> mip, 1u);
+            u32 const size_z = std::max(info.size[2] >> mip, 1u);
+            usize const blocks_x = (size_x + block.extent_x - 1) / block.extent_x;
+            usize const blocks_y = (size_y + block.extent_y - 1) / block.extent_y;
+            usize const row_pitch = (blocks_x * block_size + row_alignment - 1) / row_alignment * row_alignment;
+            usize const depth_pitch = row_pitch * blocks_y;
+            usize const layer_pitch = depth_pitch * size_z;
+            offset = (offset + region_alignment - 1) / region_alignment * region_alignment;
+            layout.regions.push_back({
+                .copy = {
+                    .buffer_offset = offset,
+                    .buffer_row_length = static_cast<u32>(row_pitch / block_size * block.extent_x),
+                    .buffer_image_height = static_cast<u32>(blocks_y * block.extent_y),
+                    .image_slice = {
+                        .image_aspect = info.slice.image_aspect,
+                        .mip_level = mip,
+                        .base_array_layer = info.slice.base_array_layer,
+                        .layer_count = info.slice.layer_count,
+                    },
+                    .image_offset = {0, 0, 0},
+                    .image_extent = {size_x, size_y, size_z},
+                },
+                .row_pitch = row_pitch,
+                .depth_pitch = depth_pitch,
+                .layer_pitch = layer_pitch,
+            });
+            offset += layer_pitch * info.slice.layer_count;
+        }
+        layout.size = offset;
+        return layout;
+    }
+
+    void CommandList::blit_image_to_image(ImageBlitInfo const & info)
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "blits can not be recorded inside a render pass");
         impl.flush_barriers();
 
-        VkImageCopy vk_image_copy{
+        VkImageBlit vk_blit{
             .srcSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&info.src_slice),
-            .srcOffset = {*reinterpret_cast<VkOffset3D const *>(&info.src_offset)},
+            .srcOffsets = {*reinterpret_cast<VkOffset3D const *>(&info.src_offsets[0]), *reinterpret_cast<VkOffset3D const *>(&info.src_offsets[1])},
             .dstSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&info.dst_slice),
-            .dstOffset = {*reinterpret_cast<VkOffset3D const *>(&info.dst_offset)},
-            .extent = {*reinterpret_cast<VkExtent3D const *>(&info.extent)},
+            .dstOffsets = {*reinterpret_cast<VkOffset3D const *>(&info.dst_offsets[0]), *reinterpret_cast<VkOffset3D const *>(&info.dst_offsets[1])},
         };
 
-        vkCmdCopyImage(
+        vkCmdBlitImage(
             impl.vk_cmd_buffer,
             impl.impl_device.as<ImplDevice>()->slot(info.src_image).vk_image,
             static_cast<VkImageLayout>(info.src_image_layout),
             impl.impl_device.as<ImplDevice>()->slot(info.dst_image).vk_image,
             static_cast<VkImageLayout>(info.dst_image_layout),
             1,
-            &vk_image_copy);
+            &vk_blit,
+            static_cast<VkFilter>(info.filter));
+    }
+
+    void CommandList::copy_image_to_image(ImageCopyInfo const & info)
+    {
+        ImageCopyRegion const region = {
+            .src_slice = info.src_slice,
+            .src_offset = info.src_offset,
+            .dst_slice = info.dst_slice,
+            .dst_offset = info.dst_offset,
+            .extent = info.extent,
+        };
+        copy_image_to_image(ImageCopiesInfo{
+            .src_image = info.src_image,
+            .src_image_layout = info.src_image_layout,
+            .dst_image = info.dst_image,
+            .dst_image_layout = info.dst_image_layout,
+            .regions = {&region, 1},
+        });
     }
 
     void CommandList::clear_image(ImageClearInfo const & info)
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "clears can not be recorded inside a render pass");
         impl.flush_barriers();
 
         if (info.dst_slice.image_aspect & ImageAspectFlagBits::COLOR)
@@ -169,6 +300,8 @@ namespace daxa
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "clears can not be recorded inside a render pass");
         impl.flush_barriers();
 
         vkCmdFillBuffer(
@@ -183,9 +316,9 @@ namespace daxa
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
         DAXA_DBG_ASSERT_TRUE_M(size <= MAX_PUSH_CONSTANT_BYTE_SIZE, MAX_PUSH_CONSTANT_SIZE_ERROR);
         DAXA_DBG_ASSERT_TRUE_M(size % 4 == 0, "push constant size must be a multiple of 4 bytes");
-        impl.flush_barriers();
 
         vkCmdPushConstants(impl.vk_cmd_buffer, impl.pipeline_layouts[(size + 3) / 4], VK_SHADER_STAGE_ALL, offset, size, data);
     }
@@ -194,38 +327,48 @@ namespace daxa
         auto & impl = *as<ImplCommandList>();
         auto const & pipeline_impl = *pipeline.as<ImplComputePipeline>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
-        impl.flush_barriers();
-
-        vkCmdBindDescriptorSets(impl.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_impl.vk_pipeline_layout, 0, 1, &impl.impl_device.as<ImplDevice>()->gpu_table.vk_descriptor_set, 0, nullptr);
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
 
-        vkCmdBindPipeline(impl.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_impl.vk_pipeline);
+        impl.bind_pipeline(VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_impl.vk_pipeline, pipeline_impl.vk_pipeline_layout);
     }
     void CommandList::set_pipeline(RasterPipeline const & pipeline)
     {
         auto & impl = *as<ImplCommandList>();
         auto const & pipeline_impl = *pipeline.as<ImplRasterPipeline>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
-        impl.flush_barriers();
-
-        vkCmdBindDescriptorSets(impl.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_impl.vk_pipeline_layout, 0, 1, &impl.impl_device.as<ImplDevice>()->gpu_table.vk_descriptor_set, 0, nullptr);
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
 
-        vkCmdBindPipeline(impl.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_impl.vk_pipeline);
+        impl.bind_pipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_impl.vk_pipeline, pipeline_impl.vk_pipeline_layout);
     }
     void CommandList::dispatch(u32 group_x, u32 group_y, u32 group_z)
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "dispatches can not be recorded inside a render pass");
         impl.flush_barriers();
 
         vkCmdDispatch(impl.vk_cmd_buffer, group_x, group_y, group_z);
     }
 
+    void CommandList::dispatch_indirect(DispatchIndirectInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "dispatches can not be recorded inside a render pass");
+        DAXA_DBG_ASSERT_TRUE_M(info.offset % 4 == 0, "indirect dispatch offset must be a multiple of 4");
+        impl.flush_barriers();
+
+        vkCmdDispatchIndirect(impl.vk_cmd_buffer, impl.impl_device.as<ImplDevice>()->slot(info.indirect_buffer).vk_buffer, static_cast<VkDeviceSize>(info.offset));
+    }
+
     void defer_destruction_helper(void * impl_void, GPUResourceId id, u8 index)
     {
         auto & impl = *reinterpret_cast<ImplCommandList *>(impl_void);
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
         DAXA_DBG_ASSERT_TRUE_M(impl.deferred_destruction_count < DEFERRED_DESTRUCTION_COUNT_MAX, "can not defer the destruction of more than 32 resources per command list recording");
-        impl.flush_barriers();
 
         impl.deferred_destructions[impl.deferred_destruction_count++] = {id, index};
     }
@@ -242,6 +385,7 @@ namespace daxa
 
     void CommandList::destroy_image_view_deferred(ImageViewId id)
     {
+        DAXA_DBG_ASSERT_TRUE_M(!as<ImplCommandList>()->impl_device.as<ImplDevice>()->is_cached_image_view(id), "cached image views are destroyed together with their image and must not be destroyed manually");
         defer_destruction_helper(object, GPUResourceId{.index = id.index, .version = id.version}, DEFERRED_DESTRUCTION_IMAGE_VIEW_INDEX);
     }
 
@@ -254,6 +398,8 @@ namespace daxa
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.vk_cmd_buffer_level == VK_COMMAND_BUFFER_LEVEL_SECONDARY || impl.render_pass_state == ImplRenderPassState::NONE, "can not complete a command list inside a render pass");
         impl.flush_barriers();
 
         impl.recording_complete = true;
@@ -273,25 +419,56 @@ namespace daxa
         return impl.info;
     }
 
+    auto CommandList::stats() const -> CommandListStats const &
+    {
+        auto & impl = *as<ImplCommandList>();
+        return impl.stats;
+    }
+
     void CommandList::pipeline_barrier(PipelineBarrierInfo const & info)
     {
         auto & impl = *as<ImplCommandList>();
 
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "pipeline barriers can not be recorded inside a render pass");
 
-        if (impl.memory_barrier_batch_count == COMMAND_LIST_BARRIER_MAX_BATCH_SIZE)
+        if (!impl.memory_barrier_pending)
         {
-            impl.flush_barriers();
+            impl.memory_barrier = {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+            };
+            impl.memory_barrier_pending = true;
         }
+        // All barriers of a batch execute at once, so waiting on the union of all stages and accesses is equivalent.
+        impl.memory_barrier.srcStageMask |= static_cast<u64>(info.awaited_pipeline_access.stages);
+        impl.memory_barrier.srcAccessMask |= static_cast<u64>(info.awaited_pipeline_access.type);
+        impl.memory_barrier.dstStageMask |= static_cast<u64>(info.waiting_pipeline_access.stages);
+        impl.memory_barrier.dstAccessMask |= static_cast<u64>(info.waiting_pipeline_access.type);
+    }
 
-        impl.memory_barrier_batch[impl.memory_barrier_batch_count++] = {
-            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+    void CommandList::pipeline_barrier_buffer(PipelineBarrierBufferInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "pipeline barriers can not be recorded inside a render pass");
+
+        impl.buffer_barrier_batch.push_back({
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
             .pNext = nullptr,
             .srcStageMask = static_cast<u64>(info.awaited_pipeline_access.stages),
-            .srcAccessMask = static_cast<u32>(info.awaited_pipeline_access.type),
+            .srcAccessMask = static_cast<u64>(info.awaited_pipeline_access.type),
             .dstStageMask = static_cast<u64>(info.waiting_pipeline_access.stages),
-            .dstAccessMask = static_cast<u32>(info.waiting_pipeline_access.type),
-        };
+            .dstAccessMask = static_cast<u64>(info.waiting_pipeline_access.type),
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = impl.impl_device.as<ImplDevice>()->slot(info.buffer).vk_buffer,
+            .offset = static_cast<VkDeviceSize>(info.offset),
+            .size = info.size == 0 ? VK_WHOLE_SIZE : static_cast<VkDeviceSize>(info.size),
+        });
     }
 
     void CommandList::pipeline_barrier_image_transition(PipelineBarrierImageTransitionInfo const & info)
@@ -299,19 +476,16 @@ namespace daxa
         auto & impl = *as<ImplCommandList>();
 
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "pipeline barriers can not be recorded inside a render pass");
 
-        if (impl.image_barrier_batch_count == COMMAND_LIST_BARRIER_MAX_BATCH_SIZE)
-        {
-            impl.flush_barriers();
-        }
-
-        impl.image_barrier_batch[impl.image_barrier_batch_count++] = {
+        VkImageMemoryBarrier2 vk_image_barrier{
             .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
             .pNext = nullptr,
             .srcStageMask = static_cast<u64>(info.awaited_pipeline_access.stages),
-            .srcAccessMask = static_cast<u32>(info.awaited_pipeline_access.type),
+            .srcAccessMask = static_cast<u64>(info.awaited_pipeline_access.type),
             .dstStageMask = static_cast<u64>(info.waiting_pipeline_access.stages),
-            .dstAccessMask = static_cast<u32>(info.waiting_pipeline_access.type),
+            .dstAccessMask = static_cast<u64>(info.waiting_pipeline_access.type),
             .oldLayout = static_cast<VkImageLayout>(info.before_layout),
             .newLayout = static_cast<VkImageLayout>(info.after_layout),
             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -319,27 +493,283 @@ namespace daxa
             .image = impl.impl_device.as<ImplDevice>()->slot(info.image_id).vk_image,
             .subresourceRange = *reinterpret_cast<VkImageSubresourceRange const *>(&info.image_slice),
         };
+
+        if (impl.info.fold_image_barriers)
+        {
+            for (auto & pending : impl.image_barrier_batch)
+            {
+                bool const same_subresource =
+                    pending.image == vk_image_barrier.image &&
+                    std::memcmp(&pending.subresourceRange, &vk_image_barrier.subresourceRange, sizeof(VkImageSubresourceRange)) == 0;
+                // No work was recorded in between, so the second transition can continue where the first one ends.
+                if (same_subresource && (vk_image_barrier.oldLayout == pending.newLayout || vk_image_barrier.oldLayout == VK_IMAGE_LAYOUT_UNDEFINED))
+                {
+                    pending.srcStageMask |= vk_image_barrier.srcStageMask;
+                    pending.srcAccessMask |= vk_image_barrier.srcAccessMask;
+                    pending.dstStageMask |= vk_image_barrier.dstStageMask;
+                    pending.dstAccessMask |= vk_image_barrier.dstAccessMask;
+                    pending.newLayout = vk_image_barrier.newLayout;
+                    return;
+                }
+            }
+        }
+
+        impl.image_barrier_batch.push_back(vk_image_barrier);
+    }
+
+    auto ImplCommandListEvent::dependency_info() const -> VkDependencyInfo
+    {
+        return VkDependencyInfo{
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr,
+            .dependencyFlags = {},
+            .memoryBarrierCount = static_cast<u32>(this->memory_barriers.size()),
+            .pMemoryBarriers = this->memory_barriers.data(),
+            .bufferMemoryBarrierCount = static_cast<u32>(this->buffer_barriers.size()),
+            .pBufferMemoryBarriers = this->buffer_barriers.data(),
+            .imageMemoryBarrierCount = static_cast<u32>(this->image_barriers.size()),
+            .pImageMemoryBarriers = this->image_barriers.data(),
+        };
+    }
+
+    auto CommandList::signal_event(EventSignalInfo const & info) -> CommandListEvent
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "events can not be recorded inside a render pass");
+        impl.flush_barriers();
+
+        auto & device = *impl.impl_device.as<ImplDevice>();
+        ImplCommandListEvent event = {.vk_event = device.acquire_event()};
+        for (auto const & barrier : info.barriers)
+        {
+            event.memory_barriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask = static_cast<u64>(barrier.awaited_pipeline_access.stages),
+                .srcAccessMask = static_cast<u64>(barrier.awaited_pipeline_access.type),
+                .dstStageMask = static_cast<u64>(barrier.waiting_pipeline_access.stages),
+                .dstAccessMask = static_cast<u64>(barrier.waiting_pipeline_access.type),
+            });
+        }
+        for (auto const & barrier : info.buffer_barriers)
+        {
+            event.buffer_barriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask = static_cast<u64>(barrier.awaited_pipeline_access.stages),
+                .srcAccessMask = static_cast<u64>(barrier.awaited_pipeline_access.type),
+                .dstStageMask = static_cast<u64>(barrier.waiting_pipeline_access.stages),
+                .dstAccessMask = static_cast<u64>(barrier.waiting_pipeline_access.type),
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer = device.slot(barrier.buffer).vk_buffer,
+                .offset = static_cast<VkDeviceSize>(barrier.offset),
+                .size = barrier.size == 0 ? VK_WHOLE_SIZE : static_cast<VkDeviceSize>(barrier.size),
+            });
+        }
+        for (auto const & barrier : info.image_barriers)
+        {
+            event.image_barriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask = static_cast<u64>(barrier.awaited_pipeline_access.stages),
+                .srcAccessMask = static_cast<u64>(barrier.awaited_pipeline_access.type),
+                .dstStageMask = static_cast<u64>(barrier.waiting_pipeline_access.stages),
+                .dstAccessMask = static_cast<u64>(barrier.waiting_pipeline_access.type),
+                .oldLayout = static_cast<VkImageLayout>(barrier.before_layout),
+                .newLayout = static_cast<VkImageLayout>(barrier.after_layout),
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = device.slot(barrier.image_id).vk_image,
+                .subresourceRange = *reinterpret_cast<VkImageSubresourceRange const *>(&barrier.image_slice),
+            });
+        }
+
+        VkDependencyInfo const vk_dependency_info = event.dependency_info();
+        vkCmdSetEvent2(impl.vk_cmd_buffer, event.vk_event, &vk_dependency_info);
+        impl.events.push_back(std::move(event));
+        return CommandListEvent{.index = static_cast<u32>(impl.events.size() - 1)};
+    }
+
+    void CommandList::wait_events(std::span<CommandListEvent const> events)
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        impl.flush_barriers();
+
+        std::vector<VkEvent> vk_events = {};
+        std::vector<VkDependencyInfo> vk_dependency_infos = {};
+        vk_events.reserve(events.size());
+        vk_dependency_infos.reserve(events.size());
+        for (auto const & event : events)
+        {
+            DAXA_DBG_ASSERT_TRUE_M(event.index < impl.events.size(), "can only wait on events signaled by the same command list");
+            vk_events.push_back(impl.events[event.index].vk_event);
+            vk_dependency_infos.push_back(impl.events[event.index].dependency_info());
+        }
+        vkCmdWaitEvents2(impl.vk_cmd_buffer, static_cast<u32>(vk_events.size()), vk_events.data(), vk_dependency_infos.data());
+        // Reusable lists signal the same events again on every submission, so they have to leave them unsignaled.
+        if (impl.info.reusable)
+        {
+            for (auto const & event : events)
+            {
+                vkCmdResetEvent2(impl.vk_cmd_buffer, impl.events[event.index].vk_event, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+            }
+        }
+    }
+
+    void CommandList::reset_timestamps(ResetTimestampsInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "query resets can not be recorded inside a render pass");
+        DAXA_DBG_ASSERT_TRUE_M(info.start_index + info.count <= info.query_pool.info().query_count, "query indices out of bounds of the pool");
+        impl.flush_barriers();
+
+        vkCmdResetQueryPool(impl.vk_cmd_buffer, info.query_pool.as<ImplTimelineQueryPool>()->vk_timeline_query_pool, info.start_index, info.count);
+    }
+
+    void CommandList::write_timestamp(WriteTimestampInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(info.query_index < info.query_pool.info().query_count, "query index out of bounds of the pool");
+        impl.flush_barriers();
+
+        vkCmdWriteTimestamp2(impl.vk_cmd_buffer, static_cast<u64>(info.pipeline_stage), info.query_pool.as<ImplTimelineQueryPool>()->vk_timeline_query_pool, info.query_index);
+    }
+
+    void CommandList::reset_gpu_zones(TimelineQueryPool & query_pool)
+    {
+        auto & query_pool_impl = *query_pool.as<ImplTimelineQueryPool>();
+        {
+            DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{query_pool_impl.zone_mtx});
+            query_pool_impl.zone_names.clear();
+        }
+        this->reset_timestamps({.query_pool = query_pool, .start_index = 0, .count = query_pool_impl.info.query_count});
+    }
+
+    auto CommandList::begin_gpu_zone(TimelineQueryPool & query_pool, std::string_view name) -> GpuZone
+    {
+        auto & query_pool_impl = *query_pool.as<ImplTimelineQueryPool>();
+        u32 query_index = {};
+        {
+            DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{query_pool_impl.zone_mtx});
+            query_index = static_cast<u32>(query_pool_impl.zone_names.size() * 2);
+            DAXA_DBG_ASSERT_TRUE_M(query_index + 2 <= query_pool_impl.info.query_count, "timeline query pool is too small for another gpu zone");
+            if (query_index + 2 > query_pool_impl.info.query_count)
+            {
+                return GpuZone{.query_index = GPU_ZONE_DROPPED_QUERY_INDEX};
+            }
+            query_pool_impl.zone_names.push_back(std::string{name});
+        }
+        this->write_timestamp({.query_pool = query_pool, .query_index = query_index, .pipeline_stage = PipelineStageFlagBits::TOP_OF_PIPE});
+        return GpuZone{.query_index = query_index};
+    }
+
+    void CommandList::end_gpu_zone(TimelineQueryPool & query_pool, GpuZone const & zone)
+    {
+        if (zone.query_index == GPU_ZONE_DROPPED_QUERY_INDEX)
+        {
+            return;
+        }
+        this->write_timestamp({.query_pool = query_pool, .query_index = zone.query_index + 1, .pipeline_stage = PipelineStageFlagBits::BOTTOM_OF_PIPE});
+    }
+
+    void CommandList::reset_queries(ResetQueriesInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "query resets can not be recorded inside a render pass");
+        DAXA_DBG_ASSERT_TRUE_M(info.start_index + info.count <= info.query_pool.info().query_count, "query indices out of bounds of the pool");
+        impl.flush_barriers();
+
+        vkCmdResetQueryPool(impl.vk_cmd_buffer, info.query_pool.as<ImplQueryPool>()->vk_query_pool, info.start_index, info.count);
+    }
+
+    void CommandList::begin_query(BeginQueryInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(info.query_index < info.query_pool.info().query_count, "query index out of bounds of the pool");
+        impl.flush_barriers();
+
+        bool const precise = info.precise && info.query_pool.info().type == QueryType::OCCLUSION && impl.impl_device.as<ImplDevice>()->occlusion_query_precise_enabled;
+        vkCmdBeginQuery(impl.vk_cmd_buffer, info.query_pool.as<ImplQueryPool>()->vk_query_pool, info.query_index, precise ? VK_QUERY_CONTROL_PRECISE_BIT : 0);
+    }
+
+    void CommandList::end_query(EndQueryInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(info.query_index < info.query_pool.info().query_count, "query index out of bounds of the pool");
+        impl.flush_barriers();
+
+        vkCmdEndQuery(impl.vk_cmd_buffer, info.query_pool.as<ImplQueryPool>()->vk_query_pool, info.query_index);
+    }
+
+    void CommandList::copy_query_results(CopyQueryResultsInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can not record commands to completed command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "query result copies can not be recorded inside a render pass");
+        DAXA_DBG_ASSERT_TRUE_M(info.start_index + info.count <= info.query_pool.info().query_count, "query indices out of bounds of the pool");
+        impl.flush_barriers();
+
+        usize const stride = (info.query_pool.values_per_query() + (info.with_availability ? 1 : 0)) * sizeof(u64);
+        VkQueryResultFlags vk_query_result_flags = VK_QUERY_RESULT_64_BIT;
+        if (info.with_availability)
+        {
+            vk_query_result_flags |= VK_QUERY_RESULT_WITH_AVAILABILITY_BIT;
+        }
+        if (info.wait_for_results)
+        {
+            vk_query_result_flags |= VK_QUERY_RESULT_WAIT_BIT;
+        }
+        vkCmdCopyQueryPoolResults(
+            impl.vk_cmd_buffer,
+            info.query_pool.as<ImplQueryPool>()->vk_query_pool,
+            info.start_index,
+            info.count,
+            impl.impl_device.as<ImplDevice>()->slot(info.dst_buffer).vk_buffer,
+            static_cast<VkDeviceSize>(info.dst_offset),
+            static_cast<VkDeviceSize>(stride),
+            vk_query_result_flags);
     }
 
     void CommandList::begin_renderpass(RenderPassBeginInfo const & info)
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::NONE, "render passes can not be recorded inside a render pass");
+        DAXA_DBG_ASSERT_TRUE_M(impl.vk_cmd_buffer_level == VK_COMMAND_BUFFER_LEVEL_PRIMARY, "secondary command lists inherit their render pass and can not begin one");
         impl.flush_barriers();
 
         auto fill_rendering_attachment_info = [&](RenderAttachmentInfo const & in, VkRenderingAttachmentInfo & out)
         {
             DAXA_DBG_ASSERT_TRUE_M(!in.image_view.is_empty(), "must provide either image view to render attachment");
             VkImageView vk_image_view = VK_NULL_HANDLE;
+            AttachmentResolveInfo const resolve = in.resolve.value_or(AttachmentResolveInfo{.layout = ImageLayout::UNDEFINED, .mode = ResolveMode::NONE});
+            DAXA_DBG_ASSERT_TRUE_M(resolve.mode == ResolveMode::NONE || !resolve.image_view.is_empty(), "must provide an image view to resolve into");
 
             out = VkRenderingAttachmentInfo{
                 .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
                 .pNext = nullptr,
                 .imageView = impl.impl_device.as<ImplDevice>()->slot(in.image_view).vk_image_view,
                 .imageLayout = *reinterpret_cast<VkImageLayout const *>(&in.layout),
-                .resolveMode = VkResolveModeFlagBits::VK_RESOLVE_MODE_NONE,
-                .resolveImageView = VK_NULL_HANDLE,
-                .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                .resolveMode = static_cast<VkResolveModeFlagBits>(resolve.mode),
+                .resolveImageView = resolve.mode != ResolveMode::NONE ? impl.impl_device.as<ImplDevice>()->slot(resolve.image_view).vk_image_view : VK_NULL_HANDLE,
+                .resolveImageLayout = static_cast<VkImageLayout>(resolve.layout),
                 .loadOp = static_cast<VkAttachmentLoadOp>(in.load_op),
                 .storeOp = static_cast<VkAttachmentStoreOp>(in.store_op),
                 .clearValue = *reinterpret_cast<VkClearValue const *>(&in.clear_value),
@@ -369,60 +799,86 @@ namespace daxa
         VkRenderingInfo vk_rendering_info{
             .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
             .pNext = nullptr,
-            .flags = {},
+            .flags = info.secondary_command_lists ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : VkRenderingFlags{},
             .renderArea = *reinterpret_cast<VkRect2D const *>(&info.render_area),
-            .layerCount = 1,
-            .viewMask = {},
+            .layerCount = info.layer_count,
+            .viewMask = info.view_mask,
             .colorAttachmentCount = static_cast<u32>(info.color_attachments.size()),
             .pColorAttachments = vk_color_attachments.data(),
             .pDepthAttachment = info.depth_attachment.has_value() ? &depth_attachment_info : nullptr,
             .pStencilAttachment = info.stencil_attachment.has_value() ? &stencil_attachment_info : nullptr,
         };
 
-        vkCmdSetScissor(impl.vk_cmd_buffer, 0, 1, reinterpret_cast<VkRect2D const *>(&info.render_area));
-
-        VkViewport vk_viewport = {
+        impl.set_scissor(info.render_area);
+        impl.set_viewport({
             .x = static_cast<f32>(info.render_area.x),
             .y = static_cast<f32>(info.render_area.y),
             .width = static_cast<f32>(info.render_area.width),
             .height = static_cast<f32>(info.render_area.height),
-            .minDepth = 0.0f,
-            .maxDepth = 1.0f,
-        };
-        vkCmdSetViewport(impl.vk_cmd_buffer, 0, 1, &vk_viewport);
+            .min_depth = 0.0f,
+            .max_depth = 1.0f,
+        });
 
         vkCmdBeginRendering(impl.vk_cmd_buffer, &vk_rendering_info);
+        impl.render_pass_state = info.secondary_command_lists ? ImplRenderPassState::SECONDARY_COMMAND_LISTS : ImplRenderPassState::INLINE;
+    }
+
+    void CommandList::execute_secondary_command_lists(std::span<CommandList const> secondary_command_lists)
+    {
+        auto & impl = *as<ImplCommandList>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.vk_cmd_buffer_level == VK_COMMAND_BUFFER_LEVEL_PRIMARY, "secondary command lists can only be executed by primary command lists");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state == ImplRenderPassState::SECONDARY_COMMAND_LISTS, "secondary command lists can only be executed inside a render pass begun with secondary_command_lists");
+        impl.flush_barriers();
+        std::vector<VkCommandBuffer> vk_cmd_buffers = {};
+        vk_cmd_buffers.reserve(secondary_command_lists.size());
+        for (auto const & secondary_command_list : secondary_command_lists)
+        {
+            auto const & secondary_impl = *secondary_command_list.as<ImplCommandList>();
+            DAXA_DBG_ASSERT_TRUE_M(secondary_impl.recording_complete, "secondary command lists must be completed before execution");
+            DAXA_DBG_ASSERT_TRUE_M(secondary_impl.vk_cmd_buffer_level == VK_COMMAND_BUFFER_LEVEL_SECONDARY, "only secondary command lists can be executed");
+            DAXA_DBG_ASSERT_TRUE_M(!impl.info.reusable || secondary_impl.info.reusable, "reusable command lists can only execute reusable secondary command lists");
+            vk_cmd_buffers.push_back(secondary_impl.vk_cmd_buffer);
+            impl.secondary_command_lists.push_back(secondary_command_list);
+        }
+        vkCmdExecuteCommands(impl.vk_cmd_buffer, static_cast<u32>(vk_cmd_buffers.size()), vk_cmd_buffers.data());
+        impl.reset_bound_state();
     }
 
     void CommandList::end_renderpass()
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.vk_cmd_buffer_level == VK_COMMAND_BUFFER_LEVEL_PRIMARY, "secondary command lists inherit their render pass and can not end it");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state != ImplRenderPassState::NONE, "can only end a render pass that was begun");
         impl.flush_barriers();
         vkCmdEndRendering(impl.vk_cmd_buffer);
+        impl.render_pass_state = ImplRenderPassState::NONE;
     }
 
     void CommandList::set_viewport(ViewportInfo const & info)
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
-        impl.flush_barriers();
-        vkCmdSetViewport(impl.vk_cmd_buffer, 0, 1, reinterpret_cast<VkViewport const *>(&info));
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        impl.set_viewport(info);
     }
 
     void CommandList::set_scissor(Rect2D const & info)
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
-        impl.flush_barriers();
-        vkCmdSetScissor(impl.vk_cmd_buffer, 0, 1, reinterpret_cast<VkRect2D const *>(&info));
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        impl.set_scissor(info);
     }
 
     void CommandList::set_index_buffer(BufferId id, usize offset, usize index_type_byte_size)
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
-        impl.flush_barriers();
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
 
         VkIndexType vk_index_type = {};
         switch (index_type_byte_size)
@@ -431,13 +887,24 @@ namespace daxa
         case 4: vk_index_type = VK_INDEX_TYPE_UINT32; break;
         default: DAXA_DBG_ASSERT_TRUE_M(false, "only index byte sizes 2 and 4 are supported");
         }
-        vkCmdBindIndexBuffer(impl.vk_cmd_buffer, impl.impl_device.as<ImplDevice>()->slot(id).vk_buffer, static_cast<VkDeviceSize>(offset), vk_index_type);
+        VkBuffer vk_buffer = impl.impl_device.as<ImplDevice>()->slot(id).vk_buffer;
+        if (vk_buffer == impl.bound_index_buffer && static_cast<VkDeviceSize>(offset) == impl.bound_index_buffer_offset && vk_index_type == impl.bound_index_type)
+        {
+            ++impl.stats.skipped_index_buffer_binds;
+            return;
+        }
+        vkCmdBindIndexBuffer(impl.vk_cmd_buffer, vk_buffer, static_cast<VkDeviceSize>(offset), vk_index_type);
+        impl.bound_index_buffer = vk_buffer;
+        impl.bound_index_buffer_offset = static_cast<VkDeviceSize>(offset);
+        impl.bound_index_type = vk_index_type;
     }
 
     void CommandList::draw(DrawInfo const & info)
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state != ImplRenderPassState::SECONDARY_COMMAND_LISTS, "render passes begun with secondary_command_lists can only execute secondary command lists");
         impl.flush_barriers();
         vkCmdDraw(impl.vk_cmd_buffer, info.vertex_count, info.instance_count, info.first_vertex, info.first_instance);
     }
@@ -446,77 +913,293 @@ namespace daxa
     {
         auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state != ImplRenderPassState::SECONDARY_COMMAND_LISTS, "render passes begun with secondary_command_lists can only execute secondary command lists");
         impl.flush_barriers();
         vkCmdDrawIndexed(impl.vk_cmd_buffer, info.index_count, info.instance_count, info.first_index, info.vertex_offset, info.first_instance);
     }
 
-    void CommandList::draw_indirect(DrawIndirectInfo const & info)
+    template <typename VkDrawCommandT, typename FnT>
+    static void record_indirect_draws(ImplCommandList & impl, DrawIndirectInfo const & info, FnT && vk_cmd_draw_indirect)
+    {
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state != ImplRenderPassState::SECONDARY_COMMAND_LISTS, "render passes begun with secondary_command_lists can only execute secondary command lists");
+        impl.flush_barriers();
+        auto & device = *impl.impl_device.as<ImplDevice>();
+        VkBuffer vk_buffer = device.slot(info.indirect_buffer).vk_buffer;
+        u32 const stride = info.stride == 0 ? static_cast<u32>(sizeof(VkDrawCommandT)) : info.stride;
+        if (device.multi_draw_indirect_enabled || info.draw_count <= 1)
+        {
+            vk_cmd_draw_indirect(impl.vk_cmd_buffer, vk_buffer, static_cast<VkDeviceSize>(info.offset), info.draw_count, stride);
+        }
+        else
+        {
+            for (u32 draw_index = 0; draw_index < info.draw_count; ++draw_index)
+            {
+                vk_cmd_draw_indirect(impl.vk_cmd_buffer, vk_buffer, static_cast<VkDeviceSize>(info.offset + draw_index * stride), 1, stride);
+            }
+        }
+    }
+
+    template <typename VkDrawCommandT, typename FnT>
+    static void record_indirect_count_draws(ImplCommandList & impl, DrawIndirectCountInfo const & info, FnT && vk_cmd_draw_indirect_count)
     {
-        auto & impl = *as<ImplCommandList>();
         DAXA_DBG_ASSERT_TRUE_M(impl.recording_complete == false, "can only complete uncompleted command list");
+        DAXA_DBG_ASSERT_TRUE_M(impl.recording_thread == std::this_thread::get_id(), "command lists must be recorded on the thread that created them");
+        DAXA_DBG_ASSERT_TRUE_M(impl.render_pass_state != ImplRenderPassState::SECONDARY_COMMAND_LISTS, "render passes begun with secondary_command_lists can only execute secondary command lists");
+        auto & device = *impl.impl_device.as<ImplDevice>();
+        DAXA_DBG_ASSERT_TRUE_M(device.ext_draw_indirect_count_enabled, "indirect count draws require VK_KHR_draw_indirect_count, which is not supported by this device");
         impl.flush_barriers();
-        vkCmdDrawIndirect(impl.vk_cmd_buffer, impl.impl_device.as<ImplDevice>()->slot(info.indirect_buffer).vk_buffer, info.offset, info.draw_count, info.stride);
+        vk_cmd_draw_indirect_count(
+            impl.vk_cmd_buffer,
+            device.slot(info.indirect_buffer).vk_buffer,
+            static_cast<VkDeviceSize>(info.offset),
+            device.slot(info.count_buffer).vk_buffer,
+            static_cast<VkDeviceSize>(info.count_buffer_offset),
+            info.max_draw_count,
+            info.stride == 0 ? static_cast<u32>(sizeof(VkDrawCommandT)) : info.stride);
+    }
+
+    void CommandList::draw_indirect(DrawIndirectInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        record_indirect_draws<VkDrawIndirectCommand>(impl, info, vkCmdDrawIndirect);
+    }
+
+    void CommandList::draw_indexed_indirect(DrawIndirectInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        record_indirect_draws<VkDrawIndexedIndirectCommand>(impl, info, vkCmdDrawIndexedIndirect);
+    }
+
+    void CommandList::draw_indirect_count(DrawIndirectCountInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        record_indirect_count_draws<VkDrawIndirectCommand>(impl, info, vkCmdDrawIndirectCountKHR);
+    }
+
+    void CommandList::draw_indexed_indirect_count(DrawIndirectCountInfo const & info)
+    {
+        auto & impl = *as<ImplCommandList>();
+        record_indirect_count_draws<VkDrawIndexedIndirectCommand>(impl, info, vkCmdDrawIndexedIndirectCountKHR);
     }
 
     void ImplCommandList::flush_barriers()
     {
-        if (memory_barrier_batch_count > 0 || image_barrier_batch_count > 0)
+        if (memory_barrier_pending || !buffer_barrier_batch.empty() || !image_barrier_batch.empty())
         {
             VkDependencyInfo vk_dependency_info{
                 .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
                 .pNext = nullptr,
                 .dependencyFlags = {},
-                .memoryBarrierCount = static_cast<u32>(memory_barrier_batch_count),
-                .pMemoryBarriers = memory_barrier_batch.data(),
-                .bufferMemoryBarrierCount = 0,
-                .pBufferMemoryBarriers = nullptr,
-                .imageMemoryBarrierCount = static_cast<u32>(image_barrier_batch_count),
+                .memoryBarrierCount = memory_barrier_pending ? 1u : 0u,
+                .pMemoryBarriers = &memory_barrier,
+                .bufferMemoryBarrierCount = static_cast<u32>(buffer_barrier_batch.size()),
+                .pBufferMemoryBarriers = buffer_barrier_batch.data(),
+                .imageMemoryBarrierCount = static_cast<u32>(image_barrier_batch.size()),
                 .pImageMemoryBarriers = image_barrier_batch.data(),
             };
 
             vkCmdPipelineBarrier2(vk_cmd_buffer, &vk_dependency_info);
 
-            memory_barrier_batch_count = 0;
-            image_barrier_batch_count = 0;
+            memory_barrier_pending = false;
+            buffer_barrier_batch.clear();
+            image_barrier_batch.clear();
+        }
+    }
+
+    auto ImplThreadCommandPools::acquire(VkDevice vk_device, u32 queue_family_index, VkCommandBufferLevel level, u64 timeline_value) -> std::pair<ImplCommandPool *, VkCommandBuffer>
+    {
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->mtx});
+        this->last_acquire_timeline_value = timeline_value;
+        if (this->current == nullptr || this->current->used_counts[0] + this->current->used_counts[1] == COMMAND_POOL_BUFFER_CAPACITY)
+        {
+            this->current = nullptr;
+            for (auto & pool : this->pools)
+            {
+                if (DAXA_ATOMIC_FETCH(pool->unreleased_count) == 0)
+                {
+                    this->current = pool.get();
+                    break;
+                }
+            }
+            if (this->current == nullptr)
+            {
+                auto & pool = this->pools.emplace_back(std::make_unique<ImplCommandPool>());
+                VkCommandPoolCreateInfo vk_command_pool_create_info{
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                    .queueFamilyIndex = queue_family_index,
+                };
+                vkCreateCommandPool(vk_device, &vk_command_pool_create_info, nullptr, &pool->vk_cmd_pool);
+                this->current = pool.get();
+            }
+        }
+
+        ImplCommandPool & pool = *this->current;
+        // All lists of the pool were released, so none of its buffers can be pending anymore.
+        if (DAXA_ATOMIC_FETCH(pool.unreleased_count) == 0 && pool.used_counts[0] + pool.used_counts[1] > 0)
+        {
+            vkResetCommandPool(vk_device, pool.vk_cmd_pool, {});
+            pool.used_counts = {};
+        }
+        auto & vk_cmd_buffers = pool.vk_cmd_buffers[level];
+        auto & used_count = pool.used_counts[level];
+        if (used_count == vk_cmd_buffers.size())
+        {
+            vk_cmd_buffers.resize(used_count + COMMAND_POOL_ALLOCATION_BATCH_SIZE);
+            VkCommandBufferAllocateInfo vk_command_buffer_allocate_info{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .commandPool = pool.vk_cmd_pool,
+                .level = level,
+                .commandBufferCount = static_cast<u32>(COMMAND_POOL_ALLOCATION_BATCH_SIZE),
+            };
+            vkAllocateCommandBuffers(vk_device, &vk_command_buffer_allocate_info, vk_cmd_buffers.data() + used_count);
         }
+        DAXA_ATOMIC_FETCH_INC(pool.unreleased_count);
+        return {&pool, vk_cmd_buffers[used_count++]};
+    }
+
+    void ImplThreadCommandPools::trim(VkDevice vk_device, u64 timeline_value)
+    {
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->mtx});
+        if (timeline_value < this->last_acquire_timeline_value + COMMAND_POOL_TRIM_SUBMIT_DISTANCE)
+        {
+            return;
+        }
+        std::erase_if(this->pools, [&](std::unique_ptr<ImplCommandPool> & pool)
+                      {
+            if (DAXA_ATOMIC_FETCH(pool->unreleased_count) != 0)
+            {
+                return false;
+            }
+            if (this->current == pool.get())
+            {
+                this->current = nullptr;
+            }
+            vkDestroyCommandPool(vk_device, pool->vk_cmd_pool, nullptr);
+            return true; });
+    }
+
+    void ImplThreadCommandPools::cleanup(VkDevice vk_device)
+    {
+        for (auto & pool : this->pools)
+        {
+            vkDestroyCommandPool(vk_device, pool->vk_cmd_pool, nullptr);
+        }
+        this->pools.clear();
+        this->current = nullptr;
     }
 
     ImplCommandList::ImplCommandList(ManagedWeakPtr a_impl_device)
         : impl_device{std::move(a_impl_device)}, pipeline_layouts{impl_device.as<ImplDevice>()->gpu_table.pipeline_layouts}
     {
-        // std::cout << "cmd" << std::endl;
+    }
+
+    ImplCommandList::~ImplCommandList()
+    {
+    }
 
+    void ImplCommandList::bind_pipeline(VkPipelineBindPoint bind_point, VkPipeline vk_pipeline, VkPipelineLayout vk_pipeline_layout)
+    {
+        if (this->bound_pipeline_layouts[bind_point] != vk_pipeline_layout)
+        {
+            vkCmdBindDescriptorSets(this->vk_cmd_buffer, bind_point, vk_pipeline_layout, 0, 1, &this->impl_device.as<ImplDevice>()->gpu_table.vk_descriptor_set, 0, nullptr);
+            this->bound_pipeline_layouts[bind_point] = vk_pipeline_layout;
+        }
+        else
+        {
+            ++this->stats.skipped_descriptor_set_binds;
+        }
+        if (this->bound_pipelines[bind_point] != vk_pipeline)
+        {
+            vkCmdBindPipeline(this->vk_cmd_buffer, bind_point, vk_pipeline);
+            this->bound_pipelines[bind_point] = vk_pipeline;
+        }
+        else
+        {
+            ++this->stats.skipped_pipeline_binds;
+        }
+    }
+
+    void ImplCommandList::set_viewport(ViewportInfo const & viewport)
+    {
+        if (this->bound_viewport == viewport)
+        {
+            ++this->stats.skipped_viewport_sets;
+            return;
+        }
+        vkCmdSetViewport(this->vk_cmd_buffer, 0, 1, reinterpret_cast<VkViewport const *>(&viewport));
+        this->bound_viewport = viewport;
+    }
+
+    void ImplCommandList::set_scissor(Rect2D const & scissor)
+    {
+        if (this->bound_scissor == scissor)
+        {
+            ++this->stats.skipped_scissor_sets;
+            return;
+        }
+        vkCmdSetScissor(this->vk_cmd_buffer, 0, 1, reinterpret_cast<VkRect2D const *>(&scissor));
+        this->bound_scissor = scissor;
+    }
+
+    void ImplCommandList::reset_bound_state()
+    {
+        this->bound_pipelines = {};
+        this->bound_pipeline_layouts = {};
+        this->bound_index_buffer = {};
+        this->bound_index_buffer_offset = {};
+        this->bound_index_type = {};
+        this->bound_viewport = {};
+        this->bound_scissor = {};
+    }
+
+    void ImplCommandList::acquire_command_buffer(VkCommandBufferLevel level)
+    {
+        auto & device = *this->impl_device.as<ImplDevice>();
+        if (!this->info.reusable)
+        {
+            std::tie(this->cmd_pool, this->vk_cmd_buffer) = device.thread_command_pools().acquire(device.vk_device, device.main_queue_family_index, level, DAXA_ATOMIC_FETCH(device.main_queue_cpu_timeline));
+            return;
+        }
         VkCommandPoolCreateInfo vk_command_pool_create_info{
             .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
             .pNext = nullptr,
-            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-            .queueFamilyIndex = this->impl_device.as<ImplDevice>()->main_queue_family_index,
+            .flags = {},
+            .queueFamilyIndex = device.main_queue_family_index,
         };
-
-        vkCreateCommandPool(impl_device.as<ImplDevice>()->vk_device, &vk_command_pool_create_info, nullptr, &this->vk_cmd_pool);
-
+        vkCreateCommandPool(device.vk_device, &vk_command_pool_create_info, nullptr, &this->dedicated_vk_cmd_pool);
         VkCommandBufferAllocateInfo vk_command_buffer_allocate_info{
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
             .pNext = nullptr,
-            .commandPool = this->vk_cmd_pool,
-            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandPool = this->dedicated_vk_cmd_pool,
+            .level = level,
             .commandBufferCount = 1,
         };
-
-        vkAllocateCommandBuffers(impl_device.as<ImplDevice>()->vk_device, &vk_command_buffer_allocate_info, &this->vk_cmd_buffer);
-    }
-
-    ImplCommandList::~ImplCommandList()
-    {
-        vkDestroyCommandPool(impl_device.as<ImplDevice>()->vk_device, this->vk_cmd_pool, nullptr);
+        vkAllocateCommandBuffers(device.vk_device, &vk_command_buffer_allocate_info, &this->vk_cmd_buffer);
     }
 
     void ImplCommandList::initialize(CommandListInfo const & a_info)
     {
+        this->info = a_info;
+        this->recording_thread = std::this_thread::get_id();
+        this->last_submit_timeline_value = 0;
+        this->reset_bound_state();
+        this->stats = {};
+        this->render_pass_state = ImplRenderPassState::NONE;
+
+        auto & device = *this->impl_device.as<ImplDevice>();
+        this->vk_cmd_buffer_level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        this->acquire_command_buffer(this->vk_cmd_buffer_level);
+
         VkCommandBufferBeginInfo vk_command_buffer_begin_info{
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
             .pNext = nullptr,
-            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .flags = this->info.reusable ? VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT : VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
         };
 
         vkBeginCommandBuffer(this->vk_cmd_buffer, &vk_command_buffer_begin_info);
@@ -533,26 +1216,122 @@ namespace daxa
                 .pObjectName = this->info.debug_name.c_str(),
             };
             vkSetDebugUtilsObjectNameEXT(this->impl_device.as<ImplDevice>()->vk_device, &cmd_buffer_name_info);
+        }
+    }
 
-            VkDebugUtilsObjectNameInfoEXT cmd_pool_name_info{
+    void ImplCommandList::initialize(SecondaryCommandListInfo const & a_info)
+    {
+        this->info = {.reusable = a_info.reusable, .debug_name = a_info.debug_name};
+        this->recording_thread = std::this_thread::get_id();
+        this->last_submit_timeline_value = 0;
+        this->stats = {};
+        this->render_pass_state = ImplRenderPassState::INLINE;
+
+        auto & device = *this->impl_device.as<ImplDevice>();
+        this->vk_cmd_buffer_level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        this->acquire_command_buffer(this->vk_cmd_buffer_level);
+
+        RenderPassBeginInfo const & render_pass = a_info.render_pass;
+        DAXA_DBG_ASSERT_TRUE_M(render_pass.color_attachments.size() <= COMMAND_LIST_COLOR_ATTACHMENT_MAX, "too many color attachments, make pull request to bump maximum");
+        std::array<VkFormat, COMMAND_LIST_COLOR_ATTACHMENT_MAX> vk_color_attachment_formats = {};
+        u32 sample_count = 1;
+        auto attachment_format = [&](RenderAttachmentInfo const & attachment) -> VkFormat
+        {
+            auto const & view_slot = device.slot(attachment.image_view);
+            sample_count = device.slot(view_slot.info.image).info.sample_count;
+            return static_cast<VkFormat>(view_slot.info.format);
+        };
+        for (usize i = 0; i < render_pass.color_attachments.size(); ++i)
+        {
+            vk_color_attachment_formats[i] = attachment_format(render_pass.color_attachments[i]);
+        }
+
+        VkCommandBufferInheritanceRenderingInfo vk_command_buffer_inheritance_rendering_info{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .viewMask = render_pass.view_mask,
+            .colorAttachmentCount = static_cast<u32>(render_pass.color_attachments.size()),
+            .pColorAttachmentFormats = vk_color_attachment_formats.data(),
+            .depthAttachmentFormat = render_pass.depth_attachment.has_value() ? attachment_format(render_pass.depth_attachment.value()) : VK_FORMAT_UNDEFINED,
+            .stencilAttachmentFormat = render_pass.stencil_attachment.has_value() ? attachment_format(render_pass.stencil_attachment.value()) : VK_FORMAT_UNDEFINED,
+            .rasterizationSamples = static_cast<VkSampleCountFlagBits>(sample_count),
+        };
+        VkCommandBufferInheritanceInfo vk_command_buffer_inheritance_info{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .pNext = &vk_command_buffer_inheritance_rendering_info,
+        };
+        VkCommandBufferBeginInfo vk_command_buffer_begin_info{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = (a_info.reusable ? VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT : VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT) | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+            .pInheritanceInfo = &vk_command_buffer_inheritance_info,
+        };
+        vkBeginCommandBuffer(this->vk_cmd_buffer, &vk_command_buffer_begin_info);
+
+        // Dynamic state is not inherited from the primary list.
+        this->reset_bound_state();
+        this->set_scissor(render_pass.render_area);
+        this->set_viewport({
+            .x = static_cast<f32>(render_pass.render_area.x),
+            .y = static_cast<f32>(render_pass.render_area.y),
+            .width = static_cast<f32>(render_pass.render_area.width),
+            .height = static_cast<f32>(render_pass.render_area.height),
+            .min_depth = 0.0f,
+            .max_depth = 1.0f,
+        });
+
+        recording_complete = false;
+
+        if (device.impl_ctx.as<ImplContext>()->enable_debug_names && a_info.debug_name.size() > 0)
+        {
+            VkDebugUtilsObjectNameInfoEXT cmd_buffer_name_info{
                 .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
                 .pNext = nullptr,
-                .objectType = VK_OBJECT_TYPE_COMMAND_POOL,
-                .objectHandle = reinterpret_cast<uint64_t>(this->vk_cmd_pool),
-                .pObjectName = this->info.debug_name.c_str(),
+                .objectType = VK_OBJECT_TYPE_COMMAND_BUFFER,
+                .objectHandle = reinterpret_cast<uint64_t>(this->vk_cmd_buffer),
+                .pObjectName = a_info.debug_name.c_str(),
             };
-            vkSetDebugUtilsObjectNameEXT(this->impl_device.as<ImplDevice>()->vk_device, &cmd_pool_name_info);
+            vkSetDebugUtilsObjectNameEXT(device.vk_device, &cmd_buffer_name_info);
         }
     }
 
     void ImplCommandList::reset()
     {
-        vkResetCommandPool(impl_device.as<ImplDevice>()->vk_device, this->vk_cmd_pool, VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT);
+        // The command buffer is reset together with all others of its pool, once they are all released.
+        if (this->cmd_pool != nullptr)
+        {
+            DAXA_ATOMIC_FETCH_DEC(this->cmd_pool->unreleased_count);
+            this->cmd_pool = nullptr;
+            this->vk_cmd_buffer = {};
+        }
+        if (this->dedicated_vk_cmd_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyCommandPool(this->impl_device.as<ImplDevice>()->vk_device, this->dedicated_vk_cmd_pool, nullptr);
+            this->dedicated_vk_cmd_pool = {};
+            this->vk_cmd_buffer = {};
+        }
+        this->secondary_command_lists.clear();
+        if (!this->events.empty())
+        {
+            this->impl_device.as<ImplDevice>()->release_events(this->events);
+            this->events.clear();
+        }
+        this->memory_barrier_pending = false;
+        this->buffer_barrier_batch.clear();
+        this->image_barrier_batch.clear();
         deferred_destruction_count = 0;
     }
 
     auto ImplCommandList::managed_cleanup() -> bool
     {
+        // Deferred destructions of reusable lists are skipped on retirement, all submissions have retired once the list is released.
+        // Secondary lists are never submitted themselves, the primary lists executing them keep them alive until their submissions retired.
+        // So a secondary list may be executed any number of times and still destroys its resources exactly once.
+        if ((this->info.reusable || this->vk_cmd_buffer_level == VK_COMMAND_BUFFER_LEVEL_SECONDARY) && this->deferred_destruction_count > 0)
+        {
+            this->impl_device.as<ImplDevice>()->release_deferred_destructions({this->deferred_destructions.data(), this->deferred_destruction_count});
+        }
         this->reset();
         DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->impl_device.as<ImplDevice>()->command_list_recyclable_list.mtx});
         this->impl_device.as<ImplDevice>()->command_list_recyclable_list.recyclables.emplace_back(std::unique_ptr<ImplCommandList>{this});
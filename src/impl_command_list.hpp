@@ -16,9 +16,65 @@ namespace daxa
     static inline constexpr usize DEFERRED_DESTRUCTION_SAMPLER_INDEX = 3;
     static inline constexpr usize DEFERRED_DESTRUCTION_COUNT_MAX = 32;
 
-    static inline constexpr usize COMMAND_LIST_BARRIER_MAX_BATCH_SIZE = 16;
-
     static inline constexpr usize COMMAND_LIST_COLOR_ATTACHMENT_MAX = 16;
+    // Query index of gpu zones that did not fit into their timeline query pool, they are not recorded.
+    static inline constexpr u32 GPU_ZONE_DROPPED_QUERY_INDEX = ~0u;
+
+    // Command buffers handed out by a pool before the recording thread moves on to the next pool.
+    static inline constexpr usize COMMAND_POOL_BUFFER_CAPACITY = 64;
+    // Command buffers allocated from the driver at once.
+    static inline constexpr usize COMMAND_POOL_ALLOCATION_BATCH_SIZE = 8;
+    // Threads that did not create a command list during this many main queue submissions have their idle pools destroyed,
+    // which also frees the pools of threads that exited.
+    static inline constexpr u64 COMMAND_POOL_TRIM_SUBMIT_DISTANCE = 64;
+
+    // Command buffers are handed out in order and reused after a single vkResetCommandPool,
+    // once every command list that was allocated from the pool is released.
+    // Command lists are only released after their submission retired, so a pool is recycled once all frames using it retired.
+    struct ImplCommandPool
+    {
+        VkCommandPool vk_cmd_pool = {};
+        // Indexed by VkCommandBufferLevel.
+        std::array<std::vector<VkCommandBuffer>, 2> vk_cmd_buffers = {};
+        std::array<usize, 2> used_counts = {};
+        // Decremented by whichever thread releases a command list, everything else is guarded by the owning ImplThreadCommandPools.
+        DAXA_ATOMIC_U64 unreleased_count = {};
+    };
+
+    // Pools of one recording thread, owned by the device.
+    // Reusable command lists live arbitrarily long, they use a dedicated pool instead so they never keep a shared pool from being reset.
+    struct ImplThreadCommandPools
+    {
+        // Only contended when the device trims the pools.
+        DAXA_ONLY_IF_THREADSAFETY(std::mutex mtx = {});
+        ImplCommandPool * current = {};
+        std::vector<std::unique_ptr<ImplCommandPool>> pools = {};
+        u64 last_acquire_timeline_value = {};
+
+        auto acquire(VkDevice vk_device, u32 queue_family_index, VkCommandBufferLevel level, u64 timeline_value) -> std::pair<ImplCommandPool *, VkCommandBuffer>;
+        // Destroys all pools without unreleased command lists, if the thread did not acquire a command buffer for a while.
+        void trim(VkDevice vk_device, u64 timeline_value);
+        void cleanup(VkDevice vk_device);
+    };
+
+    // Pooled event signaled by a command list, together with the dependency it was signaled with,
+    // as vkCmdWaitEvents2 has to be given the same dependency.
+    struct ImplCommandListEvent
+    {
+        VkEvent vk_event = {};
+        std::vector<VkMemoryBarrier2> memory_barriers = {};
+        std::vector<VkBufferMemoryBarrier2> buffer_barriers = {};
+        std::vector<VkImageMemoryBarrier2> image_barriers = {};
+
+        auto dependency_info() const -> VkDependencyInfo;
+    };
+
+    enum struct ImplRenderPassState
+    {
+        NONE,
+        INLINE,
+        SECONDARY_COMMAND_LISTS,
+    };
 
     struct ImplCommandList final : ManagedSharedState
     {
@@ -27,22 +83,53 @@ namespace daxa
         ManagedWeakPtr impl_device = {};
         CommandListInfo info = {};
         VkCommandBuffer vk_cmd_buffer = {};
-        VkCommandPool vk_cmd_pool = {};
+        VkCommandBufferLevel vk_cmd_buffer_level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        ImplCommandPool * cmd_pool = {};
+        // Used instead of cmd_pool by reusable lists, destroyed when the list is released.
+        VkCommandPool dedicated_vk_cmd_pool = {};
+        // Pools are shared with all other lists created on this thread, so recording is bound to it.
+        std::thread::id recording_thread = {};
         bool recording_complete = true;
-        std::array<VkMemoryBarrier2, COMMAND_LIST_BARRIER_MAX_BATCH_SIZE> memory_barrier_batch = {};
-        std::array<VkImageMemoryBarrier2, COMMAND_LIST_BARRIER_MAX_BATCH_SIZE> image_barrier_batch = {};
-        usize image_barrier_batch_count = 0;
-        usize memory_barrier_batch_count = 0;
+        // Secondary lists are recorded entirely inside the render pass they inherit.
+        ImplRenderPassState render_pass_state = ImplRenderPassState::NONE;
+        // Main queue timeline value of the latest submission, zero if the list was never submitted.
+        u64 last_submit_timeline_value = {};
+        // Executed secondary command lists, released together with this list.
+        std::vector<CommandList> secondary_command_lists = {};
+        // All global barriers of a batch are merged into memory_barrier by or-ing their stages and accesses.
+        VkMemoryBarrier2 memory_barrier = {};
+        bool memory_barrier_pending = false;
+        std::vector<VkBufferMemoryBarrier2> buffer_barrier_batch = {};
+        std::vector<VkImageMemoryBarrier2> image_barrier_batch = {};
+        // Returned to the device event pool when the list is released.
+        std::vector<ImplCommandListEvent> events = {};
         std::array<VkPipelineLayout, PIPELINE_LAYOUT_COUNT> pipeline_layouts = {};
+        // Currently bound state, used to skip redundant binds. Compute and graphics state is indexed by VkPipelineBindPoint.
+        std::array<VkPipeline, 2> bound_pipelines = {};
+        // The bindless descriptor set is rebound only when the pipeline layout changes.
+        std::array<VkPipelineLayout, 2> bound_pipeline_layouts = {};
+        VkBuffer bound_index_buffer = {};
+        VkDeviceSize bound_index_buffer_offset = {};
+        VkIndexType bound_index_type = {};
+        std::optional<ViewportInfo> bound_viewport = {};
+        std::optional<Rect2D> bound_scissor = {};
+        CommandListStats stats = {};
         std::array<std::pair<GPUResourceId, u8>, DEFERRED_DESTRUCTION_COUNT_MAX> deferred_destructions = {};
         usize deferred_destruction_count = {};
 
         void flush_barriers();
+        void bind_pipeline(VkPipelineBindPoint bind_point, VkPipeline vk_pipeline, VkPipelineLayout vk_pipeline_layout);
+        void set_viewport(ViewportInfo const & viewport);
+        void set_scissor(Rect2D const & scissor);
+        // Forgets the bound state, for example after executing secondary command lists, which leaves it undefined.
+        void reset_bound_state();
+        void acquire_command_buffer(VkCommandBufferLevel level);
 
         ImplCommandList(ManagedWeakPtr device_impl);
         virtual ~ImplCommandList() override final;
 
         void initialize(CommandListInfo const & a_info);
+        void initialize(SecondaryCommandListInfo const & a_info);
         void reset();
 
         auto managed_cleanup() -> bool override final;
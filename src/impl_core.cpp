@@ -145,6 +145,101 @@ namespace daxa
         return Access{.stages = a.stages & b.stages, .type = a.type & b.type};
     }
 
+    auto texel_block_info(Format format) -> TexelBlockInfo
+    {
+        // Format shares its numbering with VkFormat, whose core formats are grouped by texel size.
+        auto const value = static_cast<u32>(format);
+        auto uncompressed = [](u32 byte_size)
+        { return TexelBlockInfo{.extent_x = 1, .extent_y = 1, .byte_size = byte_size}; };
+        auto compressed = [](u32 extent_x, u32 extent_y, u32 byte_size)
+        { return TexelBlockInfo{.extent_x = extent_x, .extent_y = extent_y, .byte_size = byte_size}; };
+        // clang-format off
+        if (value == 0) { return {}; }
+        if (value == 1) { return uncompressed(1); }
+        if (value <= 8) { return uncompressed(2); }
+        if (value <= 15) { return uncompressed(1); }
+        if (value <= 22) { return uncompressed(2); }
+        if (value <= 36) { return uncompressed(3); }
+        if (value <= 69) { return uncompressed(4); }
+        if (value <= 76) { return uncompressed(2); }
+        if (value <= 83) { return uncompressed(4); }
+        if (value <= 90) { return uncompressed(6); }
+        if (value <= 97) { return uncompressed(8); }
+        if (value <= 100) { return uncompressed(4); }
+        if (value <= 103) { return uncompressed(8); }
+        if (value <= 106) { return uncompressed(12); }
+        if (value <= 109) { return uncompressed(16); }
+        if (value <= 112) { return uncompressed(8); }
+        if (value <= 115) { return uncompressed(16); }
+        if (value <= 118) { return uncompressed(24); }
+        if (value <= 121) { return uncompressed(32); }
+        if (value <= 123) { return uncompressed(4); }
+        // clang-format on
+        switch (format)
+        {
+        case Format::D16_UNORM: return uncompressed(2);
+        case Format::X8_D24_UNORM_PACK32: return uncompressed(4);
+        case Format::D32_SFLOAT: return uncompressed(4);
+        case Format::S8_UINT: return uncompressed(1);
+        case Format::D16_UNORM_S8_UINT: return uncompressed(3);
+        case Format::D24_UNORM_S8_UINT: return uncompressed(4);
+        case Format::D32_SFLOAT_S8_UINT: return uncompressed(5);
+        case Format::BC1_RGB_UNORM_BLOCK:
+        case Format::BC1_RGB_SRGB_BLOCK:
+        case Format::BC1_RGBA_UNORM_BLOCK:
+        case Format::BC1_RGBA_SRGB_BLOCK:
+        case Format::BC4_UNORM_BLOCK:
+        case Format::BC4_SNORM_BLOCK:
+        case Format::ETC2_R8G8B8_UNORM_BLOCK:
+        case Format::ETC2_R8G8B8_SRGB_BLOCK:
+        case Format::ETC2_R8G8B8A1_UNORM_BLOCK:
+        case Format::ETC2_R8G8B8A1_SRGB_BLOCK:
+        case Format::EAC_R11_UNORM_BLOCK:
+        case Format::EAC_R11_SNORM_BLOCK:
+        case Format::PVRTC1_4BPP_UNORM_BLOCK_IMG:
+        case Format::PVRTC2_4BPP_UNORM_BLOCK_IMG:
+        case Format::PVRTC1_4BPP_SRGB_BLOCK_IMG:
+        case Format::PVRTC2_4BPP_SRGB_BLOCK_IMG: return compressed(4, 4, 8);
+        case Format::BC2_UNORM_BLOCK:
+        case Format::BC2_SRGB_BLOCK:
+        case Format::BC3_UNORM_BLOCK:
+        case Format::BC3_SRGB_BLOCK:
+        case Format::BC5_UNORM_BLOCK:
+        case Format::BC5_SNORM_BLOCK:
+        case Format::BC6H_UFLOAT_BLOCK:
+        case Format::BC6H_SFLOAT_BLOCK:
+        case Format::BC7_UNORM_BLOCK:
+        case Format::BC7_SRGB_BLOCK:
+        case Format::ETC2_R8G8B8A8_UNORM_BLOCK:
+        case Format::ETC2_R8G8B8A8_SRGB_BLOCK:
+        case Format::EAC_R11G11_UNORM_BLOCK:
+        case Format::EAC_R11G11_SNORM_BLOCK: return compressed(4, 4, 16);
+        case Format::PVRTC1_2BPP_UNORM_BLOCK_IMG:
+        case Format::PVRTC2_2BPP_UNORM_BLOCK_IMG:
+        case Format::PVRTC1_2BPP_SRGB_BLOCK_IMG:
+        case Format::PVRTC2_2BPP_SRGB_BLOCK_IMG: return compressed(8, 4, 8);
+        case Format::A4R4G4B4_UNORM_PACK16:
+        case Format::A4B4G4R4_UNORM_PACK16: return uncompressed(2);
+        default: break;
+        }
+        static constexpr std::array<std::array<u32, 2>, 14> ASTC_BLOCK_EXTENTS = {{
+            {4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12},
+        }};
+        auto const astc_unorm_first = static_cast<u32>(Format::ASTC_4x4_UNORM_BLOCK);
+        auto const astc_sfloat_first = static_cast<u32>(Format::ASTC_4x4_SFLOAT_BLOCK);
+        if (value >= astc_unorm_first && value < astc_unorm_first + ASTC_BLOCK_EXTENTS.size() * 2)
+        {
+            auto const & extent = ASTC_BLOCK_EXTENTS[(value - astc_unorm_first) / 2];
+            return compressed(extent[0], extent[1], 16);
+        }
+        if (value >= astc_sfloat_first && value < astc_sfloat_first + ASTC_BLOCK_EXTENTS.size())
+        {
+            auto const & extent = ASTC_BLOCK_EXTENTS[value - astc_sfloat_first];
+            return compressed(extent[0], extent[1], 16);
+        }
+        return {};
+    }
+
     auto to_string(AccessTypeFlags flags) -> std::string_view
     {
         switch (flags)
@@ -5,6 +5,10 @@
 #include <fstream>
 #include <map>
 #include <deque>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <thread>
 
 #include <daxa/core.hpp>
 
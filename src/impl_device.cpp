@@ -2,6 +2,48 @@
 
 namespace daxa
 {
+    auto SamplerInfoHash::operator()(SamplerInfo const & info) const -> usize
+    {
+        usize hash = 0;
+        auto hash_combine = [&](auto const & value)
+        {
+            hash ^= std::hash<std::remove_cvref_t<decltype(value)>>{}(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        };
+        hash_combine(static_cast<u32>(info.magnification_filter));
+        hash_combine(static_cast<u32>(info.minification_filter));
+        hash_combine(static_cast<u32>(info.mipmap_filter));
+        hash_combine(static_cast<u32>(info.adress_mode_u));
+        hash_combine(static_cast<u32>(info.adress_mode_v));
+        hash_combine(static_cast<u32>(info.adress_mode_w));
+        hash_combine(info.mip_lod_bias);
+        hash_combine(info.enable_anisotropy);
+        hash_combine(info.max_anisotropy);
+        hash_combine(info.enable_compare);
+        hash_combine(static_cast<u32>(info.compareOp));
+        hash_combine(info.min_lod);
+        hash_combine(info.max_lod);
+        hash_combine(info.enable_unnormalized_coordinates);
+        return hash;
+    }
+
+    auto SamplerInfoStateEqual::operator()(SamplerInfo const & a, SamplerInfo const & b) const -> bool
+    {
+        return a.magnification_filter == b.magnification_filter &&
+               a.minification_filter == b.minification_filter &&
+               a.mipmap_filter == b.mipmap_filter &&
+               a.adress_mode_u == b.adress_mode_u &&
+               a.adress_mode_v == b.adress_mode_v &&
+               a.adress_mode_w == b.adress_mode_w &&
+               a.mip_lod_bias == b.mip_lod_bias &&
+               a.enable_anisotropy == b.enable_anisotropy &&
+               a.max_anisotropy == b.max_anisotropy &&
+               a.enable_compare == b.enable_compare &&
+               a.compareOp == b.compareOp &&
+               a.min_lod == b.min_lod &&
+               a.max_lod == b.max_lod &&
+               a.enable_unnormalized_coordinates == b.enable_unnormalized_coordinates;
+    }
+
     Device::Device(ManagedPtr impl) : ManagedPtr(std::move(impl)) {}
 
     auto Device::info() const -> DeviceInfo const &
@@ -37,6 +79,11 @@ namespace daxa
         {
             auto & impl_cmd_list = *command_list.as<ImplCommandList>();
             DAXA_DBG_ASSERT_TRUE_M(impl_cmd_list.recording_complete, "all submitted command lists must be completed before submission");
+            DAXA_DBG_ASSERT_TRUE_M(impl_cmd_list.vk_cmd_buffer_level == VK_COMMAND_BUFFER_LEVEL_PRIMARY, "secondary command lists can not be submitted");
+            DAXA_DBG_ASSERT_TRUE_M(impl_cmd_list.info.reusable || impl_cmd_list.last_submit_timeline_value == 0, "only reusable command lists can be submitted more than once");
+            // Reusable lists are recorded with SIMULTANEOUS_USE, so they may still be pending from a previous submission.
+            // Every submission keeps the list alive until it retired.
+            impl_cmd_list.last_submit_timeline_value = curreny_main_queue_cpu_timeline_value;
             submit.second.push_back(command_list);
             submit_vk_command_buffers.push_back(impl_cmd_list.vk_cmd_buffer);
         }
@@ -171,6 +218,18 @@ namespace daxa
         impl.main_queue_collect_garbage();
     }
 
+    auto Device::main_queue_timeline_value() const -> u64
+    {
+        auto & impl = *as<ImplDevice>();
+        return DAXA_ATOMIC_FETCH(impl.main_queue_cpu_timeline);
+    }
+
+    void Device::defer_until_retired(DeferredCallback && callback, u64 timeline_value)
+    {
+        auto & impl = *as<ImplDevice>();
+        impl.main_queue_defer_callback(std::move(callback), timeline_value);
+    }
+
     auto Device::create_swapchain(SwapchainInfo const & info) -> Swapchain
     {
         return Swapchain{ManagedPtr{new ImplSwapchain(this->make_weak(), info)}};
@@ -187,6 +246,12 @@ namespace daxa
         return CommandList{ManagedPtr{impl->command_list_recyclable_list.recycle_or_create_new(this->make_weak(), info).release()}};
     }
 
+    auto Device::create_secondary_command_list(SecondaryCommandListInfo const & info) -> CommandList
+    {
+        auto impl = as<ImplDevice>();
+        return CommandList{ManagedPtr{impl->command_list_recyclable_list.recycle_or_create_new(this->make_weak(), info).release()}};
+    }
+
     auto Device::create_binary_semaphore(BinarySemaphoreInfo const & info) -> BinarySemaphore
     {
         auto impl = as<ImplDevice>();
@@ -196,19 +261,124 @@ namespace daxa
     auto Device::create_timeline_semaphore(TimelineSemaphoreInfo const & info) -> TimelineSemaphore
     {
         auto impl = as<ImplDevice>();
+        DAXA_DBG_ASSERT_TRUE_M(!info.exportable || impl->ext_external_semaphore_fd_enabled, "exportable semaphores require VK_KHR_external_semaphore_fd, which is not supported by this device");
         return TimelineSemaphore{ManagedPtr{new ImplTimelineSemaphore(this->make_weak(), info)}};
     }
 
+    auto Device::create_exportable_timeline_semaphore(TimelineSemaphoreInfo const & info) -> Result<TimelineSemaphore>
+    {
+        auto & impl = *as<ImplDevice>();
+        if (!impl.ext_external_semaphore_fd_enabled)
+        {
+            return ResultErr{.message = "exportable semaphores require VK_KHR_external_semaphore_fd, which is not supported by this device"};
+        }
+        TimelineSemaphoreInfo exportable_info = info;
+        exportable_info.exportable = true;
+        return TimelineSemaphore{ManagedPtr{new ImplTimelineSemaphore(this->make_weak(), exportable_info)}};
+    }
+
+    auto Device::create_timeline_query_pool(TimelineQueryPoolInfo const & info) -> TimelineQueryPool
+    {
+        return TimelineQueryPool{ManagedPtr{new ImplTimelineQueryPool(this->make_weak(), info)}};
+    }
+
+    auto Device::create_query_pool(QueryPoolInfo const & info) -> Result<QueryPool>
+    {
+        auto & impl = *as<ImplDevice>();
+        if (info.type == QueryType::PIPELINE_STATISTICS && !impl.pipeline_statistics_query_enabled)
+        {
+            return ResultErr{.message = "pipeline statistics queries require the pipelineStatisticsQuery feature, which is not supported by this device"};
+        }
+        return QueryPool{ManagedPtr{new ImplQueryPool(this->make_weak(), info)}};
+    }
+
+    auto Device::import_timeline_semaphore_fd(ImportTimelineSemaphoreFdInfo const & info) -> Result<TimelineSemaphore>
+    {
+        auto & impl = *as<ImplDevice>();
+        if (!impl.ext_external_semaphore_fd_enabled)
+        {
+            return ResultErr{.message = "semaphore import requires VK_KHR_external_semaphore_fd, which is not supported by this device"};
+        }
+        auto timeline_semaphore = TimelineSemaphore{ManagedPtr{new ImplTimelineSemaphore(this->make_weak(), info.info)}};
+        VkImportSemaphoreFdInfoKHR vk_import_semaphore_fd_info{
+            .sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_FD_INFO_KHR,
+            .pNext = nullptr,
+            .semaphore = timeline_semaphore.as<ImplTimelineSemaphore>()->vk_semaphore,
+            .flags = {},
+            .handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT,
+            .fd = info.fd,
+        };
+        if (vkImportSemaphoreFdKHR(impl.vk_device, &vk_import_semaphore_fd_info) != VK_SUCCESS)
+        {
+            return ResultErr{.message = "failed to import semaphore file descriptor"};
+        }
+        return timeline_semaphore;
+    }
+
     auto Device::create_buffer(BufferInfo const & info) -> BufferId
     {
         auto & impl = *as<ImplDevice>();
-        return impl.new_buffer(info);
+        auto result = impl.new_buffer(info);
+        DAXA_DBG_ASSERT_TRUE_M(result.is_ok(), result.message());
+        return result.is_ok() ? result.value() : BufferId{};
+    }
+
+    auto Device::create_exportable_buffer(BufferInfo const & info) -> Result<BufferId>
+    {
+        auto & impl = *as<ImplDevice>();
+        BufferInfo exportable_info = info;
+        exportable_info.exportable = true;
+        return impl.new_buffer(exportable_info);
+    }
+
+    auto Device::import_host_buffer(ImportHostBufferInfo const & info) -> Result<BufferId>
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.import_host_buffer(info);
     }
 
     auto Device::create_image(ImageInfo const & info) -> ImageId
     {
         auto & impl = *as<ImplDevice>();
-        return impl.new_image(info);
+        auto result = impl.new_image(info);
+        DAXA_DBG_ASSERT_TRUE_M(result.is_ok(), result.message());
+        return result.is_ok() ? result.value() : ImageId{};
+    }
+
+    auto Device::create_exportable_image(ImageInfo const & info) -> Result<ImageId>
+    {
+        auto & impl = *as<ImplDevice>();
+        ImageInfo exportable_info = info;
+        exportable_info.exportable = true;
+        return impl.new_image(exportable_info);
+    }
+
+    auto Device::import_buffer_fd(ImportBufferFdInfo const & info) -> Result<BufferId>
+    {
+        auto & impl = *as<ImplDevice>();
+        DAXA_DBG_ASSERT_TRUE_M(info.fd != -1, "invalid file descriptor");
+        return impl.new_buffer(info.info, info.fd);
+    }
+
+    auto Device::import_image_fd(ImportImageFdInfo const & info) -> Result<ImageId>
+    {
+        auto & impl = *as<ImplDevice>();
+        DAXA_DBG_ASSERT_TRUE_M(info.fd != -1, "invalid file descriptor");
+        return impl.new_image(info.info, info.fd);
+    }
+
+    auto Device::export_buffer_fd(BufferId id) -> Result<i32>
+    {
+        auto & impl = *as<ImplDevice>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.slot(id).info.exportable, "buffer was not created exportable");
+        return impl.export_memory_fd(impl.slot(id).vk_device_memory);
+    }
+
+    auto Device::export_image_fd(ImageId id) -> Result<i32>
+    {
+        auto & impl = *as<ImplDevice>();
+        DAXA_DBG_ASSERT_TRUE_M(impl.slot(id).info.exportable, "image was not created exportable");
+        return impl.export_memory_fd(impl.slot(id).vk_device_memory);
     }
 
     auto Device::create_image_view(ImageViewInfo const & info) -> ImageViewId
@@ -217,6 +387,12 @@ namespace daxa
         return impl.new_image_view(info);
     }
 
+    auto Device::cached_image_view(ImageViewInfo const & info) -> ImageViewId
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.cached_image_view(info);
+    }
+
     auto Device::create_sampler(SamplerInfo const & info) -> SamplerId
     {
         auto & impl = *as<ImplDevice>();
@@ -238,6 +414,7 @@ namespace daxa
     void Device::destroy_image_view(ImageViewId id)
     {
         auto & impl = *as<ImplDevice>();
+        DAXA_DBG_ASSERT_TRUE_M(!impl.is_cached_image_view(id), "cached image views are destroyed together with their image and must not be destroyed manually");
         impl.zombiefy_image_view(id);
     }
 
@@ -271,19 +448,235 @@ namespace daxa
         return impl.slot(id).info;
     }
 
+    auto Device::is_id_valid(BufferId id) const -> bool
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.gpu_table.buffer_slots.is_id_valid(id);
+    }
+
+    auto Device::is_id_valid(ImageId id) const -> bool
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.gpu_table.image_slots.is_id_valid(id);
+    }
+
+    auto Device::is_id_valid(ImageViewId id) const -> bool
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.gpu_table.image_slots.is_id_valid(id);
+    }
+
+    auto Device::is_id_valid(SamplerId id) const -> bool
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.gpu_table.sampler_slots.is_id_valid(id);
+    }
+
     auto Device::map_memory(BufferId id) -> void *
     {
         auto & impl = *as<ImplDevice>();
+        auto & buffer_slot = impl.slot(id);
+        // Imported host memory is always mapped.
+        if (buffer_slot.vma_allocation == nullptr)
+        {
+            return buffer_slot.host_address;
+        }
         void * ret = nullptr;
-        vmaMapMemory(impl.vma_allocator, impl.slot(id).vma_allocation, &ret);
+        vmaMapMemory(impl.vma_allocator, buffer_slot.vma_allocation, &ret);
         return ret;
     }
 
     void Device::unmap_memory(BufferId id)
     {
         auto & impl = *as<ImplDevice>();
-        void * ret = nullptr;
-        vmaUnmapMemory(impl.vma_allocator, impl.slot(id).vma_allocation);
+        auto & buffer_slot = impl.slot(id);
+        if (buffer_slot.vma_allocation == nullptr)
+        {
+            return;
+        }
+        vmaUnmapMemory(impl.vma_allocator, buffer_slot.vma_allocation);
+    }
+
+    auto Device::buffer_host_address(BufferId id) const -> void *
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.slot(id).host_address;
+    }
+
+    auto Device::image_host_layout(ImageId id) const -> ImageHostLayout
+    {
+        auto & impl = *as<ImplDevice>();
+        auto const & image_slot = impl.slot(id);
+        DAXA_DBG_ASSERT_TRUE_M(image_slot.info.tiling == ImageTiling::LINEAR, "only linear images have a host layout");
+        if (image_slot.host_address == nullptr)
+        {
+            return {};
+        }
+        VkImageSubresource vk_image_subresource{
+            .aspectMask = static_cast<VkImageAspectFlags>(image_slot.info.aspect),
+            .mipLevel = 0,
+            .arrayLayer = 0,
+        };
+        VkSubresourceLayout vk_subresource_layout = {};
+        vkGetImageSubresourceLayout(impl.vk_device, image_slot.vk_image, &vk_image_subresource, &vk_subresource_layout);
+        vmaInvalidateAllocation(impl.vma_allocator, image_slot.vma_allocation, vk_subresource_layout.offset, vk_subresource_layout.size);
+        return ImageHostLayout{
+            .host_address = static_cast<u8 *>(image_slot.host_address) + vk_subresource_layout.offset,
+            .size = static_cast<usize>(vk_subresource_layout.size),
+            .row_pitch = static_cast<usize>(vk_subresource_layout.rowPitch),
+        };
+    }
+
+    // Bytes spanned by a copy region in host memory, the last row is not padded to the row length.
+    static auto host_copy_byte_size(Format format, u32 memory_row_length, u32 memory_image_height, Extent3D const & extent, u32 layer_count) -> usize
+    {
+        TexelBlockInfo const block = texel_block_info(format);
+        usize const row_blocks = (std::max(memory_row_length, extent.x) + block.extent_x - 1) / block.extent_x;
+        usize const image_rows = (std::max(memory_image_height, extent.y) + block.extent_y - 1) / block.extent_y;
+        usize const extent_row_blocks = (extent.x + block.extent_x - 1) / block.extent_x;
+        usize const extent_rows = (extent.y + block.extent_y - 1) / block.extent_y;
+        usize const row_pitch = row_blocks * block.byte_size;
+        usize const image_pitch = image_rows * row_pitch;
+        usize const image_count = static_cast<usize>(std::max(extent.z, 1u)) * layer_count;
+        return (image_count - 1) * image_pitch + (extent_rows - 1) * row_pitch + extent_row_blocks * block.byte_size;
+    }
+
+    void Device::copy_memory_to_image(MemoryToImageCopyInfo const & info)
+    {
+        auto & impl = *as<ImplDevice>();
+        if (impl.ext_host_image_copy_enabled)
+        {
+            impl.host_copy_memory_to_image(info);
+            return;
+        }
+        usize const size = host_copy_byte_size(impl.slot(info.image).info.format, info.memory_row_length, info.memory_image_height, info.image_extent, info.image_slice.layer_count);
+        // Buffer sizes are 32 bit, the memcpy would otherwise overrun a truncated staging buffer.
+        DAXA_DBG_ASSERT_TRUE_M(size <= std::numeric_limits<u32>::max(), "host image copies without VK_EXT_host_image_copy are limited to 4 GiB, split the copy");
+        if (size > std::numeric_limits<u32>::max())
+        {
+            return;
+        }
+        BufferId staging_buffer = this->create_buffer({
+            .memory_flags = MemoryFlagBits::HOST_ACCESS_SEQUENTIAL_WRITE | MemoryFlagBits::MAPPED,
+            .size = static_cast<u32>(size),
+            .debug_name = "copy_memory_to_image staging buffer",
+        });
+        std::memcpy(this->buffer_host_address(staging_buffer), info.memory_ptr, size);
+        CommandList cmd_list = this->create_command_list({.debug_name = "copy_memory_to_image"});
+        cmd_list.copy_buffer_to_image({
+            .buffer = staging_buffer,
+            .buffer_row_length = info.memory_row_length,
+            .buffer_image_height = info.memory_image_height,
+            .image = info.image,
+            .image_layout = info.image_layout,
+            .image_slice = info.image_slice,
+            .image_offset = info.image_offset,
+            .image_extent = info.image_extent,
+        });
+        cmd_list.destroy_buffer_deferred(staging_buffer);
+        cmd_list.complete();
+        this->submit_commands({.command_lists = {std::move(cmd_list)}});
+        impl.main_queue_wait_for_value(this->main_queue_timeline_value());
+    }
+
+    void Device::copy_image_to_memory(ImageToMemoryCopyInfo const & info)
+    {
+        auto & impl = *as<ImplDevice>();
+        if (impl.ext_host_image_copy_enabled)
+        {
+            impl.host_copy_image_to_memory(info);
+            return;
+        }
+        usize const size = host_copy_byte_size(impl.slot(info.image).info.format, info.memory_row_length, info.memory_image_height, info.image_extent, info.image_slice.layer_count);
+        // Buffer sizes are 32 bit, the memcpy would otherwise overrun a truncated staging buffer.
+        DAXA_DBG_ASSERT_TRUE_M(size <= std::numeric_limits<u32>::max(), "host image copies without VK_EXT_host_image_copy are limited to 4 GiB, split the copy");
+        if (size > std::numeric_limits<u32>::max())
+        {
+            return;
+        }
+        BufferId staging_buffer = this->create_buffer({
+            .memory_flags = MemoryFlagBits::HOST_ACCESS_RANDOM | MemoryFlagBits::MAPPED,
+            .size = static_cast<u32>(size),
+            .debug_name = "copy_image_to_memory staging buffer",
+        });
+        CommandList cmd_list = this->create_command_list({.debug_name = "copy_image_to_memory"});
+        cmd_list.copy_image_to_buffer({
+            .buffer = staging_buffer,
+            .buffer_row_length = info.memory_row_length,
+            .buffer_image_height = info.memory_image_height,
+            .image = info.image,
+            .image_layout = info.image_layout,
+            .image_slice = info.image_slice,
+            .image_offset = info.image_offset,
+            .image_extent = info.image_extent,
+        });
+        cmd_list.pipeline_barrier({
+            .awaited_pipeline_access = AccessConsts::TRANSFER_WRITE,
+            .waiting_pipeline_access = AccessConsts::HOST_READ,
+        });
+        cmd_list.complete();
+        this->submit_commands({.command_lists = {std::move(cmd_list)}});
+        impl.main_queue_wait_for_value(this->main_queue_timeline_value());
+        std::memcpy(info.memory_ptr, this->buffer_host_address(staging_buffer), size);
+        this->destroy_buffer(staging_buffer);
+    }
+
+    void Device::transition_image_layout(HostImageTransitionInfo const & info)
+    {
+        auto & impl = *as<ImplDevice>();
+        if (impl.ext_host_image_copy_enabled)
+        {
+            impl.host_transition_image_layout(info);
+            return;
+        }
+        CommandList cmd_list = this->create_command_list({.debug_name = "transition_image_layout"});
+        cmd_list.pipeline_barrier_image_transition({
+            .awaited_pipeline_access = AccessConsts::HOST_WRITE,
+            .waiting_pipeline_access = AccessConsts::READ_WRITE,
+            .before_layout = info.before_layout,
+            .after_layout = info.after_layout,
+            .image_id = info.image,
+            .image_slice = info.image_slice,
+        });
+        cmd_list.complete();
+        this->submit_commands({.command_lists = {std::move(cmd_list)}});
+        impl.main_queue_wait_for_value(this->main_queue_timeline_value());
+    }
+
+    auto Device::host_image_copy_supported() const -> bool
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.ext_host_image_copy_enabled;
+    }
+
+    auto Device::pipeline_statistics_query_supported() const -> bool
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.pipeline_statistics_query_enabled;
+    }
+
+    auto Device::occlusion_query_precise_supported() const -> bool
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.occlusion_query_precise_enabled;
+    }
+
+    auto Device::timestamp_query_supported() const -> bool
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.timestamp_query_enabled;
+    }
+
+    auto Device::multi_draw_indirect_supported() const -> bool
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.multi_draw_indirect_enabled;
+    }
+
+    auto Device::draw_indirect_count_supported() const -> bool
+    {
+        auto & impl = *as<ImplDevice>();
+        return impl.ext_draw_indirect_count_enabled;
     }
 
     static const VkPhysicalDeviceFeatures REQUIRED_PHYSICAL_DEVICE_FEATURES{
@@ -399,6 +792,12 @@ namespace daxa
         .scalarBlockLayout = VK_TRUE,
     };
 
+    static const VkPhysicalDeviceMultiviewFeatures REQUIRED_PHYSICAL_DEVICE_FEATURES_MULTIVIEW{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES,
+        .pNext = (void *)(&REQUIRED_PHYSICAL_DEVICE_FEATURES_SCALAR_LAYOUT),
+        .multiview = VK_TRUE,
+    };
+
     // static const VkPhysicalDeviceMultiDrawFeaturesEXT REQUIRED_PHYSICAL_DEVICE_FEATURES_MULTI_DRAW{
     //     .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_FEATURES_EXT,
     //     .pNext = (void *)(&REQUIRED_PHYSICAL_DEVICE_FEATURES_SCALAR_LAYOUT),
@@ -412,11 +811,14 @@ namespace daxa
         VkBool32 scalarBlockLayout;
     } VkPhysicalDeviceScalarBlockLayoutFeatures;
 
-    static void * REQUIRED_DEVICE_FEATURE_P_CHAIN = (void *)(&REQUIRED_PHYSICAL_DEVICE_FEATURES_SCALAR_LAYOUT);
+    static void * REQUIRED_DEVICE_FEATURE_P_CHAIN = (void *)(&REQUIRED_PHYSICAL_DEVICE_FEATURES_MULTIVIEW);
 
     ImplDevice::ImplDevice(DeviceInfo const & a_info, DeviceProperties const & a_vk_info, ManagedWeakPtr a_impl_ctx, VkPhysicalDevice a_physical_device)
         : info{a_info}, vk_info{a_vk_info}, impl_ctx{a_impl_ctx}, vk_physical_device{a_physical_device}
     {
+        static DAXA_ATOMIC_U64 device_count = {};
+        this->unique_index = DAXA_ATOMIC_FETCH_INC(device_count) + 1;
+
         // SELECT QUEUE
         this->main_queue_family_index = std::numeric_limits<u32>::max();
         u32 queue_family_props_count = 0;
@@ -442,6 +844,8 @@ namespace daxa
             }
         }
         DAXA_DBG_ASSERT_TRUE_M(this->main_queue_family_index != std::numeric_limits<u32>::max(), "found no suitable queue family");
+        this->main_queue_timestamp_valid_bits = queue_props[this->main_queue_family_index].timestampValidBits;
+        this->timestamp_query_enabled = this->vk_info.limits.timestamp_compute_and_graphics != 0 && this->main_queue_timestamp_valid_bits != 0;
 
         f32 queue_priorities[1] = {0.0};
         VkDeviceQueueCreateInfo queue_ci{
@@ -461,6 +865,17 @@ namespace daxa
             .features = REQUIRED_PHYSICAL_DEVICE_FEATURES,
         };
 
+        // Optional core features are only enabled when supported.
+        VkPhysicalDeviceFeatures supported_features = {};
+        vkGetPhysicalDeviceFeatures(a_physical_device, &supported_features);
+        physical_device_features_2.features.pipelineStatisticsQuery = supported_features.pipelineStatisticsQuery;
+        physical_device_features_2.features.occlusionQueryPrecise = supported_features.occlusionQueryPrecise;
+        this->pipeline_statistics_query_enabled = supported_features.pipelineStatisticsQuery == VK_TRUE;
+        this->occlusion_query_precise_enabled = supported_features.occlusionQueryPrecise == VK_TRUE;
+        physical_device_features_2.features.multiDrawIndirect = supported_features.multiDrawIndirect;
+        physical_device_features_2.features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+        this->multi_draw_indirect_enabled = supported_features.multiDrawIndirect == VK_TRUE;
+
         std::vector<char const *> extension_names;
         std::vector<char const *> enabled_layers;
 
@@ -472,6 +887,71 @@ namespace daxa
         extension_names.push_back(VK_KHR_SHADER_DRAW_PARAMETERS_EXTENSION_NAME);
         // extension_names.push_back(VK_EXT_MULTI_DRAW_EXTENSION_NAME);
 
+        u32 device_extension_count = 0;
+        vkEnumerateDeviceExtensionProperties(a_physical_device, nullptr, &device_extension_count, nullptr);
+        std::vector<VkExtensionProperties> device_extensions;
+        device_extensions.resize(device_extension_count);
+        vkEnumerateDeviceExtensionProperties(a_physical_device, nullptr, &device_extension_count, device_extensions.data());
+        auto extension_supported = [&](char const * extension_name) -> bool
+        {
+            for (auto & extension : device_extensions)
+            {
+                if (!strcmp(extension.extensionName, extension_name))
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+        auto enable_extension_if_supported = [&](char const * extension_name) -> bool
+        {
+            if (extension_supported(extension_name))
+            {
+                extension_names.push_back(extension_name);
+                return true;
+            }
+            return false;
+        };
+
+        this->ext_external_memory_host_enabled = enable_extension_if_supported(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+        this->ext_external_memory_fd_enabled = enable_extension_if_supported(VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME);
+        this->ext_external_semaphore_fd_enabled = enable_extension_if_supported(VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME);
+        this->ext_draw_indirect_count_enabled = enable_extension_if_supported(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        if (this->ext_external_memory_host_enabled)
+        {
+            VkPhysicalDeviceExternalMemoryHostPropertiesEXT external_memory_host_properties{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT,
+                .pNext = nullptr,
+            };
+            VkPhysicalDeviceProperties2 physical_device_properties_2{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                .pNext = &external_memory_host_properties,
+            };
+            vkGetPhysicalDeviceProperties2(a_physical_device, &physical_device_properties_2);
+            this->min_imported_host_pointer_alignment = external_memory_host_properties.minImportedHostPointerAlignment;
+        }
+        VkPhysicalDeviceHostImageCopyFeaturesEXT physical_device_host_image_copy_features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+            .pNext = nullptr,
+            .hostImageCopy = VK_FALSE,
+        };
+        // The extension is only enabled together with its feature.
+        if (extension_supported(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME))
+        {
+            VkPhysicalDeviceFeatures2 supported_features_2{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &physical_device_host_image_copy_features,
+            };
+            vkGetPhysicalDeviceFeatures2(a_physical_device, &supported_features_2);
+            if (physical_device_host_image_copy_features.hostImageCopy == VK_TRUE)
+            {
+                physical_device_host_image_copy_features.pNext = physical_device_features_2.pNext;
+                physical_device_features_2.pNext = &physical_device_host_image_copy_features;
+                extension_names.push_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+                this->ext_host_image_copy_enabled = true;
+            }
+        }
+
         VkDeviceCreateInfo device_ci = {
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
             .pNext = &physical_device_features_2,
@@ -612,20 +1092,17 @@ namespace daxa
             for (ManagedPtr & cmd_list_mp : command_lists)
             {
                 auto cmd_list = cmd_list_mp.as<ImplCommandList>();
-                for (usize i = 0; i < cmd_list->deferred_destruction_count; ++i)
+                if (!cmd_list->info.reusable)
                 {
-                    auto [id, index] = cmd_list->deferred_destructions[i];
-                    switch (index)
-                    {
-                        case DEFERRED_DESTRUCTION_BUFFER_INDEX: this->main_queue_buffer_zombies.push_front({main_queue_cpu_timeline,BufferId{id}}); break;
-                        case DEFERRED_DESTRUCTION_IMAGE_INDEX: this->main_queue_image_zombies.push_front({main_queue_cpu_timeline, ImageId{id}}); break;
-                        case DEFERRED_DESTRUCTION_IMAGE_VIEW_INDEX: this->main_queue_image_view_zombies.push_front({main_queue_cpu_timeline, ImageViewId{id}}); break;
-                        case DEFERRED_DESTRUCTION_SAMPLER_INDEX: this->main_queue_sampler_zombies.push_front({main_queue_cpu_timeline, SamplerId{id}}); break;
-                        default: DAXA_DBG_ASSERT_TRUE_M(false, "unreachable");
-                    }
+                    this->zombiefy_deferred_destructions({cmd_list->deferred_destructions.data(), cmd_list->deferred_destruction_count}, main_queue_cpu_timeline);
                 }
             }
             command_lists.clear(); });
+        {
+            DAXA_ONLY_IF_THREADSAFETY(std::unique_lock released_lock{this->released_deferred_destructions_mtx});
+            this->zombiefy_deferred_destructions(this->released_deferred_destructions, main_queue_cpu_timeline);
+            this->released_deferred_destructions.clear();
+        }
         check_and_cleanup_gpu_resources(this->main_queue_buffer_zombies, [&](auto id)
                                         { this->cleanup_buffer(id); });
         check_and_cleanup_gpu_resources(this->main_queue_image_view_zombies, [&](auto id)
@@ -644,6 +1121,40 @@ namespace daxa
         check_and_cleanup_gpu_resources(this->main_queue_compute_pipeline_zombies, [&](auto & compute_pipeline) {});
         check_and_cleanup_gpu_resources(this->main_queue_raster_pipeline_zombies, [&](auto & raster_pipeline) {});
         check_and_cleanup_gpu_resources(this->main_queue_timeline_semaphore_zombies, [&](auto & timeline_semaphore) {});
+        check_and_cleanup_gpu_resources(this->main_queue_timeline_query_pool_zombies, [&](auto & timeline_query_pool) {});
+        check_and_cleanup_gpu_resources(this->main_queue_query_pool_zombies, [&](auto & query_pool) {});
+        {
+            DAXA_ONLY_IF_THREADSAFETY(std::unique_lock pools_lock{this->thread_command_pools_mtx});
+            for (auto & [thread_id, thread_command_pools] : this->thread_command_pools_map)
+            {
+                thread_command_pools->trim(this->vk_device, main_queue_cpu_timeline);
+            }
+        }
+
+        auto deferred_callback_heap_cmp = [](auto const & a, auto const & b)
+        { return a.first > b.first; };
+        std::vector<DeferredCallback> retired_callbacks = {};
+        while (!this->main_queue_deferred_callbacks.empty() && this->main_queue_deferred_callbacks.front().first <= gpu_timeline_value)
+        {
+            std::pop_heap(this->main_queue_deferred_callbacks.begin(), this->main_queue_deferred_callbacks.end(), deferred_callback_heap_cmp);
+            retired_callbacks.push_back(std::move(this->main_queue_deferred_callbacks.back().second));
+            this->main_queue_deferred_callbacks.pop_back();
+        }
+        // Callbacks may call back into the device (for example to destroy resources), so they must run without holding the zombie lock.
+        DAXA_ONLY_IF_THREADSAFETY(lock.unlock());
+        for (auto & callback : retired_callbacks)
+        {
+            callback();
+        }
+    }
+
+    void ImplDevice::main_queue_defer_callback(DeferredCallback && callback, u64 timeline_value)
+    {
+        DAXA_DBG_ASSERT_TRUE_M(static_cast<bool>(callback), "can not defer empty callback");
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->main_queue_zombies_mtx});
+        this->main_queue_deferred_callbacks.push_back({timeline_value, std::move(callback)});
+        std::push_heap(this->main_queue_deferred_callbacks.begin(), this->main_queue_deferred_callbacks.end(), [](auto const & a, auto const & b)
+                       { return a.first > b.first; });
     }
 
     void ImplDevice::wait_idle()
@@ -652,11 +1163,16 @@ namespace daxa
         vkDeviceWaitIdle(this->vk_device);
     }
 
-    auto ImplDevice::new_buffer(BufferInfo const & info) -> BufferId
+    auto ImplDevice::new_buffer(BufferInfo const & info, i32 import_fd) -> Result<BufferId>
     {
-        auto [id, ret] = gpu_table.buffer_slots.new_slot();
-
         DAXA_DBG_ASSERT_TRUE_M(info.size > 0, "can not create buffers of size zero");
+        bool const external_memory = info.exportable || import_fd != -1;
+        if (external_memory && !this->ext_external_memory_fd_enabled)
+        {
+            return ResultErr{.message = "external memory requires VK_KHR_external_memory_fd, which is not supported by this device"};
+        }
+
+        auto [id, ret] = gpu_table.buffer_slots.new_slot();
 
         ret.info = info;
 
@@ -677,9 +1193,15 @@ namespace daxa
             VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
             VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR;
 
+        VkExternalMemoryBufferCreateInfo vk_external_memory_buffer_create_info{
+            .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT,
+        };
+
         VkBufferCreateInfo vk_buffer_create_info{
             .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-            .pNext = nullptr,
+            .pNext = external_memory ? &vk_external_memory_buffer_create_info : nullptr,
             .flags = {},
             .size = static_cast<VkDeviceSize>(info.size),
             .usage = usageFlags,
@@ -697,7 +1219,35 @@ namespace daxa
             .priority = 0.5f,
         };
 
-        vmaCreateBuffer(this->vma_allocator, &vk_buffer_create_info, &vma_allocation_create_info, &ret.vk_buffer, &ret.vma_allocation, nullptr);
+        if (external_memory)
+        {
+            vkCreateBuffer(this->vk_device, &vk_buffer_create_info, nullptr, &ret.vk_buffer);
+            VkMemoryRequirements vk_memory_requirements = {};
+            vkGetBufferMemoryRequirements(this->vk_device, ret.vk_buffer, &vk_memory_requirements);
+            auto vk_device_memory = allocate_external_memory(vk_memory_requirements, ret.vk_buffer, VK_NULL_HANDLE, import_fd);
+            if (vk_device_memory.is_err())
+            {
+                vkDestroyBuffer(this->vk_device, ret.vk_buffer, nullptr);
+                ret = {};
+                gpu_table.buffer_slots.return_slot(id);
+                return ResultErr{.message = vk_device_memory.message()};
+            }
+            ret.vk_device_memory = vk_device_memory.value();
+            vkBindBufferMemory(this->vk_device, ret.vk_buffer, ret.vk_device_memory, 0);
+        }
+        else
+        {
+            VmaAllocationInfo vma_allocation_info = {};
+            vmaCreateBuffer(this->vma_allocator, &vk_buffer_create_info, &vma_allocation_create_info, &ret.vk_buffer, &ret.vma_allocation, &vma_allocation_info);
+
+            // With HOST_ACCESS_ALLOW_TRANSFER_INSTEAD vma may fall back to memory that is not host visible and therefore not mapped.
+            VkMemoryPropertyFlags vk_memory_property_flags = {};
+            vmaGetAllocationMemoryProperties(this->vma_allocator, ret.vma_allocation, &vk_memory_property_flags);
+            if ((vk_memory_property_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0)
+            {
+                ret.host_address = vma_allocation_info.pMappedData;
+            }
+        }
 
         if (this->impl_ctx.as<ImplContext>()->enable_debug_names && info.debug_name.size() > 0)
         {
@@ -716,6 +1266,141 @@ namespace daxa
         return BufferId{id};
     }
 
+    auto ImplDevice::import_host_buffer(ImportHostBufferInfo const & info) -> Result<BufferId>
+    {
+        if (!this->ext_external_memory_host_enabled)
+        {
+            return ResultErr{.message = "host buffer import requires VK_EXT_external_memory_host, which is not supported by this device"};
+        }
+        DAXA_DBG_ASSERT_TRUE_M(info.size > 0, "can not import buffers of size zero");
+        // BufferInfo stores the size as u32, larger files have to be imported in multiple buffers.
+        if (info.size > std::numeric_limits<u32>::max())
+        {
+            return ResultErr{.message = "imported buffer size exceeds the maximum buffer size of " + std::to_string(std::numeric_limits<u32>::max()) + " bytes"};
+        }
+        if (reinterpret_cast<usize>(info.host_address) % this->min_imported_host_pointer_alignment != 0 ||
+            info.size % this->min_imported_host_pointer_alignment != 0)
+        {
+            return ResultErr{.message = "host address and size must be aligned to " + std::to_string(this->min_imported_host_pointer_alignment) + " bytes"};
+        }
+
+        VkMemoryHostPointerPropertiesEXT vk_host_pointer_properties{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT,
+            .pNext = nullptr,
+        };
+        if (vkGetMemoryHostPointerPropertiesEXT(this->vk_device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, info.host_address, &vk_host_pointer_properties) != VK_SUCCESS)
+        {
+            return ResultErr{.message = "host address can not be imported"};
+        }
+
+        VkBufferUsageFlags const vk_buffer_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                                   VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                   VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                                                   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                                   VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+
+        VkPhysicalDeviceExternalBufferInfo vk_external_buffer_info{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_BUFFER_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .usage = vk_buffer_usage,
+            .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+        };
+        VkExternalBufferProperties vk_external_buffer_properties{
+            .sType = VK_STRUCTURE_TYPE_EXTERNAL_BUFFER_PROPERTIES,
+            .pNext = nullptr,
+        };
+        vkGetPhysicalDeviceExternalBufferProperties(this->vk_physical_device, &vk_external_buffer_info, &vk_external_buffer_properties);
+        if ((vk_external_buffer_properties.externalMemoryProperties.externalMemoryFeatures & VK_EXTERNAL_MEMORY_FEATURE_IMPORTABLE_BIT) == 0)
+        {
+            return ResultErr{.message = "host allocations can not be imported as buffers on this device"};
+        }
+
+        VkExternalMemoryBufferCreateInfo vk_external_memory_buffer_create_info{
+            .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+        };
+
+        VkBufferCreateInfo vk_buffer_create_info{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = &vk_external_memory_buffer_create_info,
+            .flags = {},
+            .size = static_cast<VkDeviceSize>(info.size),
+            .usage = vk_buffer_usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 1,
+            .pQueueFamilyIndices = &this->main_queue_family_index,
+        };
+
+        VkBuffer vk_buffer = {};
+        if (vkCreateBuffer(this->vk_device, &vk_buffer_create_info, nullptr, &vk_buffer) != VK_SUCCESS)
+        {
+            return ResultErr{.message = "failed to create buffer for imported host memory"};
+        }
+
+        VkMemoryRequirements vk_memory_requirements = {};
+        vkGetBufferMemoryRequirements(this->vk_device, vk_buffer, &vk_memory_requirements);
+        u32 memory_type_bits = vk_memory_requirements.memoryTypeBits & vk_host_pointer_properties.memoryTypeBits;
+        if (memory_type_bits == 0)
+        {
+            vkDestroyBuffer(this->vk_device, vk_buffer, nullptr);
+            return ResultErr{.message = "no memory type is compatible with the imported host address"};
+        }
+
+        VkImportMemoryHostPointerInfoEXT vk_import_memory_host_pointer_info{
+            .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT,
+            .pNext = nullptr,
+            .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+            .pHostPointer = info.host_address,
+        };
+        VkMemoryAllocateInfo vk_memory_allocate_info{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = &vk_import_memory_host_pointer_info,
+            .allocationSize = static_cast<VkDeviceSize>(info.size),
+            .memoryTypeIndex = static_cast<u32>(std::countr_zero(memory_type_bits)),
+        };
+        VkDeviceMemory vk_device_memory = {};
+        if (vkAllocateMemory(this->vk_device, &vk_memory_allocate_info, nullptr, &vk_device_memory) != VK_SUCCESS)
+        {
+            vkDestroyBuffer(this->vk_device, vk_buffer, nullptr);
+            return ResultErr{.message = "failed to import host memory"};
+        }
+        if (vkBindBufferMemory(this->vk_device, vk_buffer, vk_device_memory, 0) != VK_SUCCESS)
+        {
+            vkFreeMemory(this->vk_device, vk_device_memory, nullptr);
+            vkDestroyBuffer(this->vk_device, vk_buffer, nullptr);
+            return ResultErr{.message = "failed to bind imported host memory"};
+        }
+
+        auto [id, ret] = gpu_table.buffer_slots.new_slot();
+        ret.info = BufferInfo{
+            .memory_flags = {},
+            .size = static_cast<u32>(info.size),
+            .debug_name = info.debug_name,
+        };
+        ret.vk_buffer = vk_buffer;
+        ret.vk_device_memory = vk_device_memory;
+        ret.host_address = info.host_address;
+
+        if (this->impl_ctx.as<ImplContext>()->enable_debug_names && info.debug_name.size() > 0)
+        {
+            VkDebugUtilsObjectNameInfoEXT buffer_name_info{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+                .pNext = nullptr,
+                .objectType = VK_OBJECT_TYPE_BUFFER,
+                .objectHandle = reinterpret_cast<uint64_t>(ret.vk_buffer),
+                .pObjectName = info.debug_name.c_str(),
+            };
+            vkSetDebugUtilsObjectNameEXT(vk_device, &buffer_name_info);
+        }
+
+        write_descriptor_set_buffer(this->vk_device, this->gpu_table.vk_descriptor_set, ret.vk_buffer, 0, static_cast<VkDeviceSize>(info.size), id.index);
+
+        return BufferId{id};
+    }
+
     auto ImplDevice::validate_image_slice(ImageMipArraySlice const & slice, ImageId id) -> ImageMipArraySlice
     {
         if (slice.level_count == std::numeric_limits<u32>::max() || slice.level_count == 0)
@@ -807,8 +1492,14 @@ namespace daxa
         return ImageId{id};
     }
 
-    auto ImplDevice::new_image(ImageInfo const & info) -> ImageId
+    auto ImplDevice::new_image(ImageInfo const & info, i32 import_fd) -> Result<ImageId>
     {
+        bool const external_memory = info.exportable || import_fd != -1;
+        if (external_memory && !this->ext_external_memory_fd_enabled)
+        {
+            return ResultErr{.message = "external memory requires VK_KHR_external_memory_fd, which is not supported by this device"};
+        }
+
         auto [id, image_slot_variant] = gpu_table.image_slots.new_slot();
 
         VkDevice vk_device = this->vk_device;
@@ -831,12 +1522,29 @@ namespace daxa
 
         DAXA_DBG_ASSERT_TRUE_M(info.dimensions >= 1 && info.dimensions <= 3, "image dimensions must be a value between 1 to 3(inclusive)");
         DAXA_DBG_ASSERT_TRUE_M(std::popcount(info.sample_count) == 1 && info.sample_count <= 64, "image samples must be power of two and between 1 and 64(inclusive)");
+        DAXA_DBG_ASSERT_TRUE_M(
+            info.tiling == ImageTiling::OPTIMAL || (info.dimensions == 2 && info.mip_level_count == 1 && info.array_layer_count == 1 && info.sample_count == 1),
+            "linear images must be single sampled 2d images with one mip and array layer");
 
         VkImageType vk_image_type = static_cast<VkImageType>(info.dimensions - 1);
 
+        // Without host image copies, Device::copy_memory_to_image and copy_image_to_memory fall back to transfer commands.
+        VkImageUsageFlags vk_image_usage = info.usage;
+        if ((vk_image_usage & ImageUsageFlagBits::HOST_TRANSFER) != 0 && !this->ext_host_image_copy_enabled)
+        {
+            vk_image_usage &= ~ImageUsageFlagBits::HOST_TRANSFER;
+            vk_image_usage |= ImageUsageFlagBits::TRANSFER_SRC | ImageUsageFlagBits::TRANSFER_DST;
+        }
+
+        VkExternalMemoryImageCreateInfo vk_external_memory_image_create_info{
+            .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+            .pNext = nullptr,
+            .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT,
+        };
+
         VkImageCreateInfo vk_image_create_info{
             .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-            .pNext = nullptr,
+            .pNext = external_memory ? &vk_external_memory_image_create_info : nullptr,
             .flags = {},
             .imageType = vk_image_type,
             .format = *reinterpret_cast<VkFormat const *>(&info.format),
@@ -844,8 +1552,8 @@ namespace daxa
             .mipLevels = info.mip_level_count,
             .arrayLayers = info.array_layer_count,
             .samples = static_cast<VkSampleCountFlagBits>(info.sample_count),
-            .tiling = VK_IMAGE_TILING_OPTIMAL,
-            .usage = info.usage,
+            .tiling = static_cast<VkImageTiling>(info.tiling),
+            .usage = vk_image_usage,
             .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
             .queueFamilyIndexCount = 1,
             .pQueueFamilyIndices = &this->main_queue_family_index,
@@ -861,7 +1569,46 @@ namespace daxa
             .priority = 0.5f,
         };
 
-        vmaCreateImage(this->vma_allocator, &vk_image_create_info, &vma_allocation_create_info, &ret.vk_image, &ret.vma_allocation, nullptr);
+        if (external_memory)
+        {
+            vkCreateImage(vk_device, &vk_image_create_info, nullptr, &ret.vk_image);
+            VkMemoryRequirements vk_memory_requirements = {};
+            vkGetImageMemoryRequirements(vk_device, ret.vk_image, &vk_memory_requirements);
+            auto vk_device_memory = allocate_external_memory(vk_memory_requirements, VK_NULL_HANDLE, ret.vk_image, import_fd);
+            if (vk_device_memory.is_err())
+            {
+                vkDestroyImage(vk_device, ret.vk_image, nullptr);
+                image_slot_variant = {};
+                gpu_table.image_slots.return_slot(id);
+                return ResultErr{.message = vk_device_memory.message()};
+            }
+            ret.vk_device_memory = vk_device_memory.value();
+            vkBindImageMemory(vk_device, ret.vk_image, ret.vk_device_memory, 0);
+        }
+        else
+        {
+            VmaAllocationInfo vma_allocation_info = {};
+            VkResult vk_result = VK_ERROR_FEATURE_NOT_PRESENT;
+            // Transient attachments are only backed by memory when a tiler needs to spill them, if the device has lazily allocated memory.
+            if ((info.usage & ImageUsageFlagBits::TRANSIENT_ATTACHMENT) != 0)
+            {
+                VmaAllocationCreateInfo vma_lazy_allocation_create_info = vma_allocation_create_info;
+                vma_lazy_allocation_create_info.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+                vk_result = vmaCreateImage(this->vma_allocator, &vk_image_create_info, &vma_lazy_allocation_create_info, &ret.vk_image, &ret.vma_allocation, &vma_allocation_info);
+            }
+            if (vk_result != VK_SUCCESS)
+            {
+                vmaCreateImage(this->vma_allocator, &vk_image_create_info, &vma_allocation_create_info, &ret.vk_image, &ret.vma_allocation, &vma_allocation_info);
+            }
+
+            // Optimal tiling is opaque to the host, so only linear images expose their mapping.
+            VkMemoryPropertyFlags vk_memory_property_flags = {};
+            vmaGetAllocationMemoryProperties(this->vma_allocator, ret.vma_allocation, &vk_memory_property_flags);
+            if (info.tiling == ImageTiling::LINEAR && (vk_memory_property_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0)
+            {
+                ret.host_address = vma_allocation_info.pMappedData;
+            }
+        }
 
         VkImageViewType vk_image_view_type;
         if (info.array_layer_count > 1)
@@ -926,6 +1673,81 @@ namespace daxa
         return ImageId{id};
     }
 
+    auto ImplDevice::allocate_external_memory(VkMemoryRequirements const & requirements, VkBuffer dedicated_buffer, VkImage dedicated_image, i32 import_fd) -> Result<VkDeviceMemory>
+    {
+        // The memory type of imported opaque fd memory must match the exporters memory type.
+        // Both sides select it the same way, preferring the first device local memory type.
+        VkPhysicalDeviceMemoryProperties vk_memory_properties = {};
+        vkGetPhysicalDeviceMemoryProperties(this->vk_physical_device, &vk_memory_properties);
+        u32 memory_type_index = std::numeric_limits<u32>::max();
+        for (u32 i = 0; i < vk_memory_properties.memoryTypeCount; ++i)
+        {
+            if ((requirements.memoryTypeBits & (1u << i)) == 0)
+            {
+                continue;
+            }
+            if (memory_type_index == std::numeric_limits<u32>::max() ||
+                (vk_memory_properties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0)
+            {
+                memory_type_index = i;
+                if ((vk_memory_properties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0)
+                {
+                    break;
+                }
+            }
+        }
+        if (memory_type_index == std::numeric_limits<u32>::max())
+        {
+            return ResultErr{.message = "found no memory type for external memory"};
+        }
+
+        VkMemoryDedicatedAllocateInfo vk_memory_dedicated_allocate_info{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .image = dedicated_image,
+            .buffer = dedicated_buffer,
+        };
+        VkExportMemoryAllocateInfo vk_export_memory_allocate_info{
+            .sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO,
+            .pNext = &vk_memory_dedicated_allocate_info,
+            .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT,
+        };
+        VkImportMemoryFdInfoKHR vk_import_memory_fd_info{
+            .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR,
+            .pNext = &vk_memory_dedicated_allocate_info,
+            .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT,
+            .fd = import_fd,
+        };
+        VkMemoryAllocateInfo vk_memory_allocate_info{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = import_fd != -1 ? reinterpret_cast<void const *>(&vk_import_memory_fd_info) : reinterpret_cast<void const *>(&vk_export_memory_allocate_info),
+            .allocationSize = requirements.size,
+            .memoryTypeIndex = memory_type_index,
+        };
+        VkDeviceMemory vk_device_memory = {};
+        if (vkAllocateMemory(this->vk_device, &vk_memory_allocate_info, nullptr, &vk_device_memory) != VK_SUCCESS)
+        {
+            return ResultErr{.message = import_fd != -1 ? "failed to import memory file descriptor" : "failed to allocate exportable memory"};
+        }
+        return vk_device_memory;
+    }
+
+    auto ImplDevice::export_memory_fd(VkDeviceMemory vk_device_memory) -> Result<i32>
+    {
+        VkMemoryGetFdInfoKHR vk_memory_get_fd_info{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR,
+            .pNext = nullptr,
+            .memory = vk_device_memory,
+            .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT,
+        };
+        int fd = -1;
+        if (vkGetMemoryFdKHR(this->vk_device, &vk_memory_get_fd_info, &fd) != VK_SUCCESS)
+        {
+            return ResultErr{.message = "failed to export memory file descriptor"};
+        }
+        return static_cast<i32>(fd);
+    }
+
     auto ImplDevice::new_image_view(ImageViewInfo const & info) -> ImageViewId
     {
         auto [id, image_slot] = gpu_table.image_slots.new_slot();
@@ -979,8 +1801,55 @@ namespace daxa
         return ImageViewId{id};
     }
 
+    auto ImplDevice::cached_image_view(ImageViewInfo const & info) -> ImageViewId
+    {
+        ImageMipArraySlice slice = this->validate_image_slice(info.slice, info.image);
+
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock image_view_cache_lock{this->image_view_cache_mtx});
+        auto & image_views = this->image_view_cache[info.image.index];
+        for (ImageViewId view_id : image_views)
+        {
+            ImageViewInfo const & view_info = this->slot(view_id).info;
+            if (view_info.slice == slice && view_info.format == info.format && view_info.type == info.type)
+            {
+                return view_id;
+            }
+        }
+
+        ImageViewId view_id = this->new_image_view(info);
+        image_views.push_back(view_id);
+        return view_id;
+    }
+
+    auto ImplDevice::is_cached_image_view(ImageViewId id) -> bool
+    {
+        ImageId const image = this->slot(id).info.image;
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock image_view_cache_lock{this->image_view_cache_mtx});
+        auto cache_iter = this->image_view_cache.find(image.index);
+        if (cache_iter == this->image_view_cache.end())
+        {
+            return false;
+        }
+        for (ImageViewId view_id : cache_iter->second)
+        {
+            if (view_id.index == id.index && view_id.version == id.version)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
     auto ImplDevice::new_sampler(SamplerInfo const & info) -> SamplerId
     {
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock sampler_cache_lock{this->sampler_cache_mtx});
+        auto cache_iter = this->sampler_cache.find(info);
+        if (cache_iter != this->sampler_cache.end())
+        {
+            cache_iter->second.second += 1;
+            return cache_iter->second.first;
+        }
+
         auto [id, ret] = gpu_table.sampler_slots.new_slot();
 
         ret.info = info;
@@ -1022,16 +1891,154 @@ namespace daxa
 
         write_descriptor_set_sampler(this->vk_device, this->gpu_table.vk_descriptor_set, ret.vk_sampler, id.index);
 
+        this->sampler_cache.emplace(info, std::pair{SamplerId{id}, u64{1}});
+
         return SamplerId{id};
     }
 
+    void ImplDevice::host_copy_memory_to_image(MemoryToImageCopyInfo const & info)
+    {
+        VkMemoryToImageCopyEXT vk_memory_to_image_copy{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+            .pNext = nullptr,
+            .pHostPointer = info.memory_ptr,
+            .memoryRowLength = info.memory_row_length,
+            .memoryImageHeight = info.memory_image_height,
+            .imageSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&info.image_slice),
+            .imageOffset = *reinterpret_cast<VkOffset3D const *>(&info.image_offset),
+            .imageExtent = *reinterpret_cast<VkExtent3D const *>(&info.image_extent),
+        };
+        VkCopyMemoryToImageInfoEXT vk_copy_memory_to_image_info{
+            .sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+            .pNext = nullptr,
+            .flags = {},
+            .dstImage = this->slot(info.image).vk_image,
+            .dstImageLayout = static_cast<VkImageLayout>(info.image_layout),
+            .regionCount = 1,
+            .pRegions = &vk_memory_to_image_copy,
+        };
+        vkCopyMemoryToImageEXT(this->vk_device, &vk_copy_memory_to_image_info);
+    }
+
+    void ImplDevice::host_copy_image_to_memory(ImageToMemoryCopyInfo const & info)
+    {
+        VkImageToMemoryCopyEXT vk_image_to_memory_copy{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_TO_MEMORY_COPY_EXT,
+            .pNext = nullptr,
+            .pHostPointer = info.memory_ptr,
+            .memoryRowLength = info.memory_row_length,
+            .memoryImageHeight = info.memory_image_height,
+            .imageSubresource = *reinterpret_cast<VkImageSubresourceLayers const *>(&info.image_slice),
+            .imageOffset = *reinterpret_cast<VkOffset3D const *>(&info.image_offset),
+            .imageExtent = *reinterpret_cast<VkExtent3D const *>(&info.image_extent),
+        };
+        VkCopyImageToMemoryInfoEXT vk_copy_image_to_memory_info{
+            .sType = VK_STRUCTURE_TYPE_COPY_IMAGE_TO_MEMORY_INFO_EXT,
+            .pNext = nullptr,
+            .flags = {},
+            .srcImage = this->slot(info.image).vk_image,
+            .srcImageLayout = static_cast<VkImageLayout>(info.image_layout),
+            .regionCount = 1,
+            .pRegions = &vk_image_to_memory_copy,
+        };
+        vkCopyImageToMemoryEXT(this->vk_device, &vk_copy_image_to_memory_info);
+    }
+
+    void ImplDevice::host_transition_image_layout(HostImageTransitionInfo const & info)
+    {
+        ImageMipArraySlice const slice = this->validate_image_slice(info.image_slice, info.image);
+        VkHostImageLayoutTransitionInfoEXT vk_host_image_layout_transition_info{
+            .sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT,
+            .pNext = nullptr,
+            .image = this->slot(info.image).vk_image,
+            .oldLayout = static_cast<VkImageLayout>(info.before_layout),
+            .newLayout = static_cast<VkImageLayout>(info.after_layout),
+            .subresourceRange = *reinterpret_cast<VkImageSubresourceRange const *>(&slice),
+        };
+        vkTransitionImageLayoutEXT(this->vk_device, 1, &vk_host_image_layout_transition_info);
+    }
+
+    auto ImplDevice::thread_command_pools() -> ImplThreadCommandPools &
+    {
+        // Recording threads usually stick to one device, so the map is only searched when the thread switches devices.
+        thread_local u64 cached_device_unique_index = {};
+        thread_local ImplThreadCommandPools * cached_thread_command_pools = {};
+        if (cached_device_unique_index != this->unique_index)
+        {
+            DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->thread_command_pools_mtx});
+            auto & thread_command_pools = this->thread_command_pools_map[std::this_thread::get_id()];
+            if (!thread_command_pools)
+            {
+                thread_command_pools = std::make_unique<ImplThreadCommandPools>();
+            }
+            cached_device_unique_index = this->unique_index;
+            cached_thread_command_pools = thread_command_pools.get();
+        }
+        return *cached_thread_command_pools;
+    }
+
+    auto ImplDevice::acquire_event() -> VkEvent
+    {
+        {
+            DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->event_pool_mtx});
+            if (!this->event_pool.empty())
+            {
+                VkEvent vk_event = this->event_pool.back();
+                this->event_pool.pop_back();
+                return vk_event;
+            }
+        }
+        VkEventCreateInfo vk_event_create_info{
+            .sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+        };
+        VkEvent vk_event = {};
+        vkCreateEvent(this->vk_device, &vk_event_create_info, nullptr, &vk_event);
+        return vk_event;
+    }
+
+    void ImplDevice::release_events(std::span<ImplCommandListEvent> events)
+    {
+        for (auto & event : events)
+        {
+            vkResetEvent(this->vk_device, event.vk_event);
+        }
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->event_pool_mtx});
+        for (auto & event : events)
+        {
+            this->event_pool.push_back(event.vk_event);
+        }
+    }
+
+    void ImplDevice::main_queue_wait_for_value(u64 timeline_value)
+    {
+        VkSemaphoreWaitInfo vk_semaphore_wait_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .semaphoreCount = 1,
+            .pSemaphores = &this->vk_main_queue_gpu_timeline_semaphore,
+            .pValues = &timeline_value,
+        };
+        vkWaitSemaphores(this->vk_device, &vk_semaphore_wait_info, std::numeric_limits<u64>::max());
+    }
+
     void ImplDevice::cleanup_buffer(BufferId id)
     {
         ImplBufferSlot & buffer_slot = this->gpu_table.buffer_slots.dereference_id(id);
 
         write_descriptor_set_buffer(this->vk_device, this->gpu_table.vk_descriptor_set, VK_NULL_HANDLE, 0, VK_WHOLE_SIZE, id.index);
 
-        vmaDestroyBuffer(this->vma_allocator, buffer_slot.vk_buffer, buffer_slot.vma_allocation);
+        if (buffer_slot.vma_allocation != nullptr)
+        {
+            vmaDestroyBuffer(this->vma_allocator, buffer_slot.vk_buffer, buffer_slot.vma_allocation);
+        }
+        else
+        {
+            vkDestroyBuffer(this->vk_device, buffer_slot.vk_buffer, nullptr);
+            vkFreeMemory(this->vk_device, buffer_slot.vk_device_memory, nullptr);
+        }
 
         buffer_slot = {};
 
@@ -1050,6 +2057,11 @@ namespace daxa
         {
             vmaDestroyImage(this->vma_allocator, image_slot.vk_image, image_slot.vma_allocation);
         }
+        else if (image_slot.vk_device_memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(vk_device, image_slot.vk_image, nullptr);
+            vkFreeMemory(vk_device, image_slot.vk_device_memory, nullptr);
+        }
 
         image_slot = {};
 
@@ -1089,8 +2101,28 @@ namespace daxa
         wait_idle();
         main_queue_collect_garbage();
 
+        // The device is idle, callbacks deferred past the last submission are safe to run now.
+        for (auto & [timeline_value, callback] : this->main_queue_deferred_callbacks)
+        {
+            callback();
+        }
+        this->main_queue_deferred_callbacks.clear();
+        // The callbacks may have released the last reference to query pools.
+        this->main_queue_timeline_query_pool_zombies.clear();
+        this->main_queue_query_pool_zombies.clear();
+
         binary_semaphore_recyclable_list.clear();
         command_list_recyclable_list.clear();
+        for (auto & [thread_id, thread_command_pools] : this->thread_command_pools_map)
+        {
+            thread_command_pools->cleanup(this->vk_device);
+        }
+        this->thread_command_pools_map.clear();
+        for (VkEvent vk_event : this->event_pool)
+        {
+            vkDestroyEvent(this->vk_device, vk_event, nullptr);
+        }
+        this->event_pool.clear();
 
         vmaDestroyAllocator(this->vma_allocator);
         this->gpu_table.cleanup(this->vk_device);
@@ -1112,9 +2144,54 @@ namespace daxa
     {
         DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->main_queue_zombies_mtx});
         u64 main_queue_cpu_timeline = DAXA_ATOMIC_FETCH(this->main_queue_cpu_timeline);
+        this->zombiefy_cached_image_views(id, main_queue_cpu_timeline);
         this->main_queue_image_zombies.push_front({main_queue_cpu_timeline, id});
     }
 
+    void ImplDevice::zombiefy_deferred_destructions(std::span<std::pair<GPUResourceId, u8> const> deferred_destructions, u64 main_queue_cpu_timeline)
+    {
+        for (auto [id, index] : deferred_destructions)
+        {
+            switch (index)
+            {
+            case DEFERRED_DESTRUCTION_BUFFER_INDEX: this->main_queue_buffer_zombies.push_front({main_queue_cpu_timeline, BufferId{id}}); break;
+            case DEFERRED_DESTRUCTION_IMAGE_INDEX:
+                this->zombiefy_cached_image_views(ImageId{id}, main_queue_cpu_timeline);
+                this->main_queue_image_zombies.push_front({main_queue_cpu_timeline, ImageId{id}});
+                break;
+            case DEFERRED_DESTRUCTION_IMAGE_VIEW_INDEX: this->main_queue_image_view_zombies.push_front({main_queue_cpu_timeline, ImageViewId{id}}); break;
+            case DEFERRED_DESTRUCTION_SAMPLER_INDEX:
+                if (this->release_sampler(SamplerId{id}))
+                {
+                    this->main_queue_sampler_zombies.push_front({main_queue_cpu_timeline, SamplerId{id}});
+                }
+                break;
+            default: DAXA_DBG_ASSERT_TRUE_M(false, "unreachable");
+            }
+        }
+    }
+
+    void ImplDevice::release_deferred_destructions(std::span<std::pair<GPUResourceId, u8> const> deferred_destructions)
+    {
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->released_deferred_destructions_mtx});
+        this->released_deferred_destructions.insert(this->released_deferred_destructions.end(), deferred_destructions.begin(), deferred_destructions.end());
+    }
+
+    void ImplDevice::zombiefy_cached_image_views(ImageId id, u64 main_queue_cpu_timeline)
+    {
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock image_view_cache_lock{this->image_view_cache_mtx});
+        auto cache_iter = this->image_view_cache.find(id.index);
+        if (cache_iter == this->image_view_cache.end())
+        {
+            return;
+        }
+        for (ImageViewId view_id : cache_iter->second)
+        {
+            this->main_queue_image_view_zombies.push_front({main_queue_cpu_timeline, view_id});
+        }
+        this->image_view_cache.erase(cache_iter);
+    }
+
     void ImplDevice::zombiefy_image_view(ImageViewId id)
     {
         DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->main_queue_zombies_mtx});
@@ -1124,11 +2201,34 @@ namespace daxa
 
     void ImplDevice::zombiefy_sampler(SamplerId id)
     {
+        if (!this->release_sampler(id))
+        {
+            return;
+        }
         DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->main_queue_zombies_mtx});
         u64 main_queue_cpu_timeline = DAXA_ATOMIC_FETCH(this->main_queue_cpu_timeline);
         this->main_queue_sampler_zombies.push_front({main_queue_cpu_timeline, id});
     }
 
+    auto ImplDevice::release_sampler(SamplerId id) -> bool
+    {
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock sampler_cache_lock{this->sampler_cache_mtx});
+        auto cache_iter = this->sampler_cache.find(this->slot(id).info);
+        bool const cached = cache_iter != this->sampler_cache.end() && cache_iter->second.first.index == id.index;
+        DAXA_DBG_ASSERT_TRUE_M(cached, "detected double destroy of sampler");
+        if (!cached)
+        {
+            return false;
+        }
+        cache_iter->second.second -= 1;
+        if (cache_iter->second.second == 0)
+        {
+            this->sampler_cache.erase(cache_iter);
+            return true;
+        }
+        return false;
+    }
+
     auto ImplDevice::slot(BufferId id) -> ImplBufferSlot &
     {
         return gpu_table.buffer_slots.dereference_id(id);
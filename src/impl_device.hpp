@@ -11,10 +11,23 @@
 #include "impl_command_list.hpp"
 #include "impl_swapchain.hpp"
 #include "impl_semaphore.hpp"
+#include "impl_timeline_query.hpp"
+#include "impl_query_pool.hpp"
 #include "impl_gpu_resources.hpp"
 
 namespace daxa
 {
+    // Identifies a sampler by its state, the debug name is ignored.
+    struct SamplerInfoHash
+    {
+        auto operator()(SamplerInfo const & info) const -> usize;
+    };
+
+    struct SamplerInfoStateEqual
+    {
+        auto operator()(SamplerInfo const & a, SamplerInfo const & b) const -> bool;
+    };
+
     struct ImplDevice final : ManagedSharedState
     {
         ManagedWeakPtr impl_ctx = {};
@@ -25,15 +38,48 @@ namespace daxa
         DeviceInfo info = {};
         VkSampler vk_dummy_sampler = {};
 
+        // Optional extensions, enabled when the physical device supports them:
+        bool ext_external_memory_host_enabled = {};
+        VkDeviceSize min_imported_host_pointer_alignment = {};
+        bool ext_external_memory_fd_enabled = {};
+        bool ext_external_semaphore_fd_enabled = {};
+        bool ext_host_image_copy_enabled = {};
+        bool pipeline_statistics_query_enabled = {};
+        bool occlusion_query_precise_enabled = {};
+        bool timestamp_query_enabled = {};
+        bool multi_draw_indirect_enabled = {};
+        bool ext_draw_indirect_count_enabled = {};
+
         // Gpu resource table:
         GPUResourceTable gpu_table = {};
 
+        // Samplers with identical state share one id, the cache holds the number of create_sampler calls for each.
+        DAXA_ONLY_IF_THREADSAFETY(std::mutex sampler_cache_mtx = {});
+        std::unordered_map<SamplerInfo, std::pair<SamplerId, u64>, SamplerInfoHash, SamplerInfoStateEqual> sampler_cache = {};
+        // Image views owned by the device, indexed by the parent image index. They are destroyed together with the parent image.
+        DAXA_ONLY_IF_THREADSAFETY(std::mutex image_view_cache_mtx = {});
+        std::unordered_map<u32, std::vector<ImageViewId>> image_view_cache = {};
+
         // Resource recycling:
         RecyclableList<ImplCommandList> command_list_recyclable_list = {};
+        // Command pools of each recording thread, see ImplCommandPool.
+        DAXA_ONLY_IF_THREADSAFETY(std::mutex thread_command_pools_mtx = {});
+        std::unordered_map<std::thread::id, std::unique_ptr<ImplThreadCommandPools>> thread_command_pools_map = {};
+        // Distinguishes devices in the thread local pool lookup, as a new device can reuse the address of a destroyed one.
+        u64 unique_index = {};
+        auto thread_command_pools() -> ImplThreadCommandPools &;
+        // Unsignaled events, used by CommandList::signal_event.
+        DAXA_ONLY_IF_THREADSAFETY(std::mutex event_pool_mtx = {});
+        std::vector<VkEvent> event_pool = {};
+        auto acquire_event() -> VkEvent;
+        // The events must not be used by pending gpu work anymore.
+        void release_events(std::span<ImplCommandListEvent> events);
         RecyclableList<ImplBinarySemaphore> binary_semaphore_recyclable_list = {};
         // Main queue:
         VkQueue main_queue_vk_queue = {};
         u32 main_queue_family_index = {};
+        // Zero if the main queue does not support timestamps.
+        u32 main_queue_timestamp_valid_bits = {};
 
         DAXA_ATOMIC_U64 main_queue_cpu_timeline = {};
         VkSemaphore vk_main_queue_gpu_timeline_semaphore = {};
@@ -46,9 +92,14 @@ namespace daxa
         std::deque<std::pair<u64, SamplerId>> main_queue_sampler_zombies = {};
         std::deque<std::pair<u64, std::unique_ptr<ImplBinarySemaphore>>> main_queue_binary_semaphore_zombies = {};
         std::deque<std::pair<u64, std::unique_ptr<ImplTimelineSemaphore>>> main_queue_timeline_semaphore_zombies = {};
+        std::deque<std::pair<u64, std::unique_ptr<ImplTimelineQueryPool>>> main_queue_timeline_query_pool_zombies = {};
+        std::deque<std::pair<u64, std::unique_ptr<ImplQueryPool>>> main_queue_query_pool_zombies = {};
         std::deque<std::pair<u64, std::unique_ptr<ImplComputePipeline>>> main_queue_compute_pipeline_zombies = {};
         std::deque<std::pair<u64, std::unique_ptr<ImplRasterPipeline>>> main_queue_raster_pipeline_zombies = {};
+        // Min heap on the timeline value, as callbacks can be deferred to arbitrary timeline values.
+        std::vector<std::pair<u64, DeferredCallback>> main_queue_deferred_callbacks = {};
         void main_queue_collect_garbage();
+        void main_queue_defer_callback(DeferredCallback && callback, u64 timeline_value);
         void wait_idle();
 
         ImplDevice(DeviceInfo const & info, DeviceProperties const & vk_info, ManagedWeakPtr impl_ctx, VkPhysicalDevice physical_device);
@@ -57,11 +108,22 @@ namespace daxa
         auto validate_image_slice(ImageMipArraySlice const & slice, ImageId id) -> ImageMipArraySlice;
         auto validate_image_slice(ImageMipArraySlice const & slice, ImageViewId id) -> ImageMipArraySlice;
 
-        auto new_buffer(BufferInfo const & info) -> BufferId;
+        // Passing an import_fd imports the memory of the buffer/ image instead of allocating it.
+        auto new_buffer(BufferInfo const & info, i32 import_fd = -1) -> Result<BufferId>;
+        auto import_host_buffer(ImportHostBufferInfo const & info) -> Result<BufferId>;
         auto new_swapchain_image(VkImage swapchain_image, VkFormat format, u32 index, ImageUsageFlags usage, const std::string & debug_name) -> ImageId;
-        auto new_image(ImageInfo const & info) -> ImageId;
+        auto new_image(ImageInfo const & info, i32 import_fd = -1) -> Result<ImageId>;
+        auto allocate_external_memory(VkMemoryRequirements const & requirements, VkBuffer dedicated_buffer, VkImage dedicated_image, i32 import_fd) -> Result<VkDeviceMemory>;
+        auto export_memory_fd(VkDeviceMemory vk_device_memory) -> Result<i32>;
         auto new_image_view(ImageViewInfo const & info) -> ImageViewId;
+        auto cached_image_view(ImageViewInfo const & info) -> ImageViewId;
+        auto is_cached_image_view(ImageViewId id) -> bool;
         auto new_sampler(SamplerInfo const & info) -> SamplerId;
+        // Require ext_host_image_copy_enabled, Device implements the fallback.
+        void host_copy_memory_to_image(MemoryToImageCopyInfo const & info);
+        void host_copy_image_to_memory(ImageToMemoryCopyInfo const & info);
+        void host_transition_image_layout(HostImageTransitionInfo const & info);
+        void main_queue_wait_for_value(u64 timeline_value);
 
         auto slot(BufferId id) -> ImplBufferSlot &;
         auto slot(ImageId id) -> ImplImageSlot &;
@@ -77,6 +139,16 @@ namespace daxa
         void zombiefy_image(ImageId id);
         void zombiefy_image_view(ImageViewId id);
         void zombiefy_sampler(SamplerId id);
+        // Requires main_queue_zombies_mtx to be locked.
+        void zombiefy_cached_image_views(ImageId id, u64 main_queue_cpu_timeline);
+        // Requires main_queue_zombies_mtx to be locked.
+        void zombiefy_deferred_destructions(std::span<std::pair<GPUResourceId, u8> const> deferred_destructions, u64 main_queue_cpu_timeline);
+        // Deferred destructions of released reusable command lists, zombified by the next main_queue_collect_garbage.
+        DAXA_ONLY_IF_THREADSAFETY(std::mutex released_deferred_destructions_mtx = {});
+        std::vector<std::pair<GPUResourceId, u8>> released_deferred_destructions = {};
+        void release_deferred_destructions(std::span<std::pair<GPUResourceId, u8> const> deferred_destructions);
+        // Returns true when the last reference was released and the sampler must be destroyed.
+        auto release_sampler(SamplerId id) -> bool;
 
         void cleanup_buffer(BufferId id);
         void cleanup_image(ImageId id);
@@ -16,6 +16,9 @@ namespace daxa
         BufferInfo info = {};
         VkBuffer vk_buffer = {};
         VmaAllocation vma_allocation = {};
+        // Only used by imported and exportable buffers, that are not allocated by vma.
+        VkDeviceMemory vk_device_memory = {};
+        void * host_address = {};
     };
 
     static inline constexpr i32 NOT_OWNED_BY_SWAPCHAIN = -1;
@@ -32,6 +35,10 @@ namespace daxa
         ImageInfo info = {};
         VkImage vk_image = {};
         VmaAllocation vma_allocation = {};
+        // Only used by imported and exportable images, that are not allocated by vma.
+        VkDeviceMemory vk_device_memory = {};
+        // Persistent mapping of linear images in host visible memory.
+        void * host_address = {};
         i32 swapchain_image_index = NOT_OWNED_BY_SWAPCHAIN;
     };
 
@@ -137,6 +144,21 @@ namespace daxa
             free_index_stack.push_back(id.index);
         }
 
+        // Whether the id refers to a live resource, its slot was not returned since it was handed out.
+        auto is_id_valid(GPUResourceId id) const -> bool
+        {
+            usize page = id.index >> PAGE_BITS;
+            usize offset = id.index & PAGE_MASK;
+            if (id.version == 0 || page >= PAGE_COUNT)
+            {
+                return false;
+            }
+#if DAXA_GPU_ID_VALIDATION
+            DAXA_ONLY_IF_THREADSAFETY(std::unique_lock use_after_free_check_lock{use_after_free_check_mtx});
+#endif
+            return pages[page] != nullptr && pages[page]->at(offset).second == id.version;
+        }
+
         auto dereference_id(GPUResourceId id) -> ResourceT &
         {
             usize page = id.index >> PAGE_BITS;
@@ -191,10 +191,11 @@ namespace daxa
             .pNext = nullptr,
             .topology = VkPrimitiveTopology::VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
         };
-        constexpr VkPipelineMultisampleStateCreateInfo vk_multisample_state{
+        DAXA_DBG_ASSERT_TRUE_M(std::popcount(info.sample_count) == 1 && info.sample_count <= 64, "pipeline samples must be power of two and between 1 and 64(inclusive)");
+        VkPipelineMultisampleStateCreateInfo const vk_multisample_state{
             .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
             .pNext = nullptr,
-            .rasterizationSamples = VkSampleCountFlagBits::VK_SAMPLE_COUNT_1_BIT,
+            .rasterizationSamples = static_cast<VkSampleCountFlagBits>(info.sample_count),
             .minSampleShading = 1.0f,
         };
 
@@ -271,6 +272,7 @@ namespace daxa
         VkPipelineRenderingCreateInfo vk_pipeline_rendering{
             .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR,
             .pNext = nullptr,
+            .viewMask = info.view_mask,
             .colorAttachmentCount = static_cast<u32>(info.color_attachments.size()),
             .pColorAttachmentFormats = vk_pipeline_color_attachment_formats.data(),
             .depthAttachmentFormat = static_cast<VkFormat>(info.depth_test.depth_attachment_format),
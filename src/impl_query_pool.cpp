@@ -0,0 +1,88 @@
+#include "impl_query_pool.hpp"
+#include "impl_device.hpp"
+
+#include <bit>
+
+namespace daxa
+{
+    QueryPool::QueryPool(ManagedPtr impl) : ManagedPtr(std::move(impl)) {}
+
+    auto QueryPool::info() const -> QueryPoolInfo const &
+    {
+        auto & impl = *as<ImplQueryPool>();
+        return impl.info;
+    }
+
+    auto QueryPool::values_per_query() const -> u32
+    {
+        auto & impl = *as<ImplQueryPool>();
+        return impl.values_per_query;
+    }
+
+    auto QueryPool::get_query_results(u32 start_index, u32 count) -> std::vector<u64>
+    {
+        auto & impl = *as<ImplQueryPool>();
+        DAXA_DBG_ASSERT_TRUE_M(start_index + count <= impl.info.query_count, "query indices out of bounds of the pool");
+        usize const stride = impl.values_per_query + 1;
+        std::vector<u64> results(count * stride, 0);
+        if (count > 0)
+        {
+            vkGetQueryPoolResults(
+                impl.impl_device.as<ImplDevice>()->vk_device,
+                impl.vk_query_pool,
+                start_index,
+                count,
+                results.size() * sizeof(u64),
+                results.data(),
+                stride * sizeof(u64),
+                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        }
+        return results;
+    }
+
+    ImplQueryPool::ImplQueryPool(ManagedWeakPtr a_impl_device, QueryPoolInfo const & a_info)
+        : impl_device{a_impl_device}, info{a_info}
+    {
+        DAXA_DBG_ASSERT_TRUE_M(info.query_count > 0, "query pool must contain at least one query");
+        bool const pipeline_statistics = info.type == QueryType::PIPELINE_STATISTICS;
+        DAXA_DBG_ASSERT_TRUE_M(!pipeline_statistics || info.pipeline_statistics != PipelineStatisticFlagBits::NONE, "pipeline statistics query pool must query at least one statistic");
+        this->values_per_query = pipeline_statistics ? static_cast<u32>(std::popcount(info.pipeline_statistics)) : 1;
+
+        VkQueryPoolCreateInfo vk_query_pool_create_info{
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .queryType = pipeline_statistics ? VK_QUERY_TYPE_PIPELINE_STATISTICS : VK_QUERY_TYPE_OCCLUSION,
+            .queryCount = info.query_count,
+            .pipelineStatistics = pipeline_statistics ? static_cast<VkQueryPipelineStatisticFlags>(info.pipeline_statistics) : 0,
+        };
+
+        vkCreateQueryPool(impl_device.as<ImplDevice>()->vk_device, &vk_query_pool_create_info, nullptr, &this->vk_query_pool);
+
+        if (this->impl_device.as<ImplDevice>()->impl_ctx.as<ImplContext>()->enable_debug_names && this->info.debug_name.size() > 0)
+        {
+            VkDebugUtilsObjectNameInfoEXT name_info{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+                .pNext = nullptr,
+                .objectType = VK_OBJECT_TYPE_QUERY_POOL,
+                .objectHandle = reinterpret_cast<u64>(this->vk_query_pool),
+                .pObjectName = this->info.debug_name.c_str(),
+            };
+            vkSetDebugUtilsObjectNameEXT(impl_device.as<ImplDevice>()->vk_device, &name_info);
+        }
+    }
+
+    ImplQueryPool::~ImplQueryPool()
+    {
+        vkDestroyQueryPool(impl_device.as<ImplDevice>()->vk_device, this->vk_query_pool, nullptr);
+        this->vk_query_pool = {};
+    }
+
+    auto ImplQueryPool::managed_cleanup() -> bool
+    {
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->impl_device.as<ImplDevice>()->main_queue_zombies_mtx});
+        u64 main_queue_cpu_timeline_value = DAXA_ATOMIC_FETCH(this->impl_device.as<ImplDevice>()->main_queue_cpu_timeline);
+        this->impl_device.as<ImplDevice>()->main_queue_query_pool_zombies.push_front({main_queue_cpu_timeline_value, std::unique_ptr<ImplQueryPool>{this}});
+        return false;
+    }
+} // namespace daxa
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <daxa/query_pool.hpp>
+
+#include "impl_core.hpp"
+
+namespace daxa
+{
+    struct ImplDevice;
+
+    struct ImplQueryPool final : ManagedSharedState
+    {
+        ManagedWeakPtr impl_device = {};
+        VkQueryPool vk_query_pool = {};
+        QueryPoolInfo info = {};
+        u32 values_per_query = {};
+
+        ImplQueryPool(ManagedWeakPtr a_impl_device, QueryPoolInfo const & a_info);
+        ~ImplQueryPool();
+
+        auto managed_cleanup() -> bool override final;
+    };
+} // namespace daxa
@@ -103,6 +103,28 @@ namespace daxa
         return result != VK_TIMEOUT;
     }
 
+    auto TimelineSemaphore::export_fd() const -> Result<i32>
+    {
+        auto & impl = *as<ImplTimelineSemaphore>();
+        if (!impl.info.exportable)
+        {
+            return ResultErr{.message = "timeline semaphore was not created exportable"};
+        }
+
+        VkSemaphoreGetFdInfoKHR vk_semaphore_get_fd_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR,
+            .pNext = nullptr,
+            .semaphore = impl.vk_semaphore,
+            .handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT,
+        };
+        int fd = -1;
+        if (vkGetSemaphoreFdKHR(impl.impl_device.as<ImplDevice>()->vk_device, &vk_semaphore_get_fd_info, &fd) != VK_SUCCESS)
+        {
+            return ResultErr{.message = "failed to export semaphore file descriptor"};
+        }
+        return static_cast<i32>(fd);
+    }
+
     auto TimelineSemaphore::info() const -> TimelineSemaphoreInfo const &
     {
         auto & impl = *as<ImplTimelineSemaphore>();
@@ -114,9 +136,18 @@ namespace daxa
     {
         // std::cout << "tsem" << std::endl;
 
+        // Unsupported export requests are rejected by Device, without the extension the semaphore is created as not exportable.
+        this->info.exportable = this->info.exportable && impl_device.as<ImplDevice>()->ext_external_semaphore_fd_enabled;
+
+        VkExportSemaphoreCreateInfo vk_export_semaphore_create_info{
+            .sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO,
+            .pNext = nullptr,
+            .handleTypes = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT,
+        };
+
         VkSemaphoreTypeCreateInfo timeline_vk_semaphore{
             .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
-            .pNext = nullptr,
+            .pNext = info.exportable ? &vk_export_semaphore_create_info : nullptr,
             .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
             .initialValue = info.initial_value,
         };
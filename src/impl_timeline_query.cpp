@@ -0,0 +1,125 @@
+#include "impl_timeline_query.hpp"
+#include "impl_device.hpp"
+
+namespace daxa
+{
+    TimelineQueryPool::TimelineQueryPool(ManagedPtr impl) : ManagedPtr(std::move(impl)) {}
+
+    auto TimelineQueryPool::info() const -> TimelineQueryPoolInfo const &
+    {
+        auto & impl = *as<ImplTimelineQueryPool>();
+        return impl.info;
+    }
+
+    auto TimelineQueryPool::get_query_results(u32 start_index, u32 count) -> std::vector<u64>
+    {
+        auto & impl = *as<ImplTimelineQueryPool>();
+        return impl.get_query_results(start_index, count);
+    }
+
+    void TimelineQueryPool::resolve_gpu_zones(u64 timeline_value, GpuZoneCallback callback)
+    {
+        auto & impl = *as<ImplTimelineQueryPool>();
+        std::vector<std::string> zone_names = {};
+        {
+            DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{impl.zone_mtx});
+            zone_names = impl.zone_names;
+        }
+        auto & device = *impl.impl_device.as<ImplDevice>();
+        DAXA_DBG_ASSERT_TRUE_M(device.timestamp_query_enabled, "gpu zones require Device::timestamp_query_supported");
+        if (!device.timestamp_query_enabled)
+        {
+            return;
+        }
+        f64 const timestamp_period = static_cast<f64>(device.vk_info.limits.timestamp_period);
+        // Bits above timestampValidBits are undefined, and the counter wraps within the valid bits.
+        u32 const valid_bits = device.main_queue_timestamp_valid_bits;
+        u64 const timestamp_mask = valid_bits >= 64 ? ~u64{0} : (u64{1} << valid_bits) - 1;
+        device.main_queue_defer_callback(
+            [query_pool = *this, zone_names = std::move(zone_names), callback = std::move(callback), timestamp_period, timestamp_mask]() mutable
+            {
+                auto results = query_pool.get_query_results(0, static_cast<u32>(zone_names.size() * 2));
+                std::vector<GpuZoneResult> zones = {};
+                zones.reserve(zone_names.size());
+                for (usize i = 0; i < zone_names.size(); ++i)
+                {
+                    // Each query yields a (timestamp, availability) pair.
+                    u64 const begin = results[i * 4 + 0] & timestamp_mask;
+                    u64 const end = results[i * 4 + 2] & timestamp_mask;
+                    if (results[i * 4 + 1] == 0 || results[i * 4 + 3] == 0)
+                    {
+                        continue;
+                    }
+                    zones.push_back(GpuZoneResult{
+                        .name = std::move(zone_names[i]),
+                        .milliseconds = static_cast<f64>((end - begin) & timestamp_mask) * timestamp_period / 1'000'000.0,
+                    });
+                }
+                callback(zones);
+            },
+            timeline_value);
+    }
+
+    ImplTimelineQueryPool::ImplTimelineQueryPool(ManagedWeakPtr a_impl_device, TimelineQueryPoolInfo const & a_info)
+        : impl_device{a_impl_device}, info{a_info}
+    {
+        DAXA_DBG_ASSERT_TRUE_M(info.query_count > 0, "timeline query pool must contain at least one query");
+        DAXA_DBG_ASSERT_TRUE_M(impl_device.as<ImplDevice>()->timestamp_query_enabled, "timeline query pools require Device::timestamp_query_supported");
+
+        VkQueryPoolCreateInfo vk_query_pool_create_info{
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .queryType = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount = info.query_count,
+            .pipelineStatistics = {},
+        };
+
+        vkCreateQueryPool(impl_device.as<ImplDevice>()->vk_device, &vk_query_pool_create_info, nullptr, &this->vk_timeline_query_pool);
+
+        if (this->impl_device.as<ImplDevice>()->impl_ctx.as<ImplContext>()->enable_debug_names && this->info.debug_name.size() > 0)
+        {
+            VkDebugUtilsObjectNameInfoEXT name_info{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+                .pNext = nullptr,
+                .objectType = VK_OBJECT_TYPE_QUERY_POOL,
+                .objectHandle = reinterpret_cast<u64>(this->vk_timeline_query_pool),
+                .pObjectName = this->info.debug_name.c_str(),
+            };
+            vkSetDebugUtilsObjectNameEXT(impl_device.as<ImplDevice>()->vk_device, &name_info);
+        }
+    }
+
+    ImplTimelineQueryPool::~ImplTimelineQueryPool()
+    {
+        vkDestroyQueryPool(impl_device.as<ImplDevice>()->vk_device, this->vk_timeline_query_pool, nullptr);
+        this->vk_timeline_query_pool = {};
+    }
+
+    auto ImplTimelineQueryPool::get_query_results(u32 start_index, u32 count) -> std::vector<u64>
+    {
+        DAXA_DBG_ASSERT_TRUE_M(start_index + count <= this->info.query_count, "query indices out of bounds of the pool");
+        std::vector<u64> results(count * 2, 0);
+        if (count > 0)
+        {
+            vkGetQueryPoolResults(
+                impl_device.as<ImplDevice>()->vk_device,
+                this->vk_timeline_query_pool,
+                start_index,
+                count,
+                results.size() * sizeof(u64),
+                results.data(),
+                2 * sizeof(u64),
+                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        }
+        return results;
+    }
+
+    auto ImplTimelineQueryPool::managed_cleanup() -> bool
+    {
+        DAXA_ONLY_IF_THREADSAFETY(std::unique_lock lock{this->impl_device.as<ImplDevice>()->main_queue_zombies_mtx});
+        u64 main_queue_cpu_timeline_value = DAXA_ATOMIC_FETCH(this->impl_device.as<ImplDevice>()->main_queue_cpu_timeline);
+        this->impl_device.as<ImplDevice>()->main_queue_timeline_query_pool_zombies.push_front({main_queue_cpu_timeline_value, std::unique_ptr<ImplTimelineQueryPool>{this}});
+        return false;
+    }
+} // namespace daxa
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <daxa/timeline_query.hpp>
+
+#include "impl_core.hpp"
+
+namespace daxa
+{
+    struct ImplDevice;
+
+    struct ImplTimelineQueryPool final : ManagedSharedState
+    {
+        ManagedWeakPtr impl_device = {};
+        VkQueryPool vk_timeline_query_pool = {};
+        TimelineQueryPoolInfo info = {};
+        // Names of the zones recorded since the last reset, zone i uses the queries 2 * i and 2 * i + 1.
+        DAXA_ONLY_IF_THREADSAFETY(std::mutex zone_mtx = {});
+        std::vector<std::string> zone_names = {};
+
+        ImplTimelineQueryPool(ManagedWeakPtr a_impl_device, TimelineQueryPoolInfo const & a_info);
+        ~ImplTimelineQueryPool();
+
+        auto get_query_results(u32 start_index, u32 count) -> std::vector<u64>;
+
+        auto managed_cleanup() -> bool override final;
+    };
+} // namespace daxa
@@ -0,0 +1,549 @@
+#if DAXA_BUILT_WITH_UTILS
+
+#include "impl_block_compression.hpp"
+
+#include <algorithm>
+
+static constexpr daxa::u32 BLOCK_COMPRESSION_MODE_BC1 = 0;
+static constexpr daxa::u32 BLOCK_COMPRESSION_MODE_BC4 = 1;
+static constexpr daxa::u32 BLOCK_COMPRESSION_MODE_BC5 = 2;
+static constexpr daxa::u32 BLOCK_COMPRESSION_MODE_BC7 = 3;
+static constexpr daxa::u32 BLOCK_COMPRESSION_WORKGROUP_SIZE = 8;
+
+struct BlockCompressionPush
+{
+    daxa::ImageViewId src_image_id;
+    daxa::BufferId dst_buffer_id;
+    daxa::u32 dst_offset;
+    daxa::u32 src_size_x;
+    daxa::u32 src_size_y;
+    daxa::u32 blocks_x;
+    daxa::u32 blocks_y;
+    daxa::u32 mode;
+    daxa::u32 refine_iterations;
+    daxa::u32 convert_to_srgb;
+};
+
+char const * block_compression_hlsl = R"--(
+    #include "daxa/daxa.hlsl"
+    DAXA_DEFINE_GET_TEXTURE2DARRAY(float4)
+
+    struct Push
+    {
+        daxa::ImageViewId src_image_id;
+        daxa::BufferId dst_buffer_id;
+        daxa::u32 dst_offset;
+        daxa::u32 src_size_x;
+        daxa::u32 src_size_y;
+        daxa::u32 blocks_x;
+        daxa::u32 blocks_y;
+        daxa::u32 mode;
+        daxa::u32 refine_iterations;
+        daxa::u32 convert_to_srgb;
+    };
+    [[vk::push_constant]] const Push p;
+
+    static const uint BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    void write_bits(inout uint4 block, inout uint offset, uint value, uint count)
+    {
+        value &= (1u << count) - 1;
+        uint word = offset / 32;
+        uint shift = offset % 32;
+        block[word] |= value << shift;
+        if (shift + count > 32)
+        {
+            block[word + 1] |= value >> (32 - shift);
+        }
+        offset += count;
+    }
+
+    float3 linear_to_srgb(float3 color)
+    {
+        float3 selector = step(float3(0.0031308, 0.0031308, 0.0031308), color);
+        float3 under = color * 12.92;
+        float3 over = 1.055 * pow(max(color, 0.0), 1.0 / 2.4) - 0.055;
+        return lerp(under, over, selector);
+    }
+
+    // Least squares fit of the endpoints to texels interpolated with the given weights.
+    void refine_endpoints(float4 texels[16], float weights[16], inout float4 e0, inout float4 e1)
+    {
+        float aa = 0, bb = 0, ab = 0;
+        float4 ax = 0, bx = 0;
+        for (uint i = 0; i < 16; ++i)
+        {
+            float b = weights[i];
+            float a = 1.0 - b;
+            aa += a * a;
+            bb += b * b;
+            ab += a * b;
+            ax += a * texels[i];
+            bx += b * texels[i];
+        }
+        float det = aa * bb - ab * ab;
+        if (abs(det) < 1e-6)
+        {
+            return;
+        }
+        e0 = saturate((ax * bb - bx * ab) / det);
+        e1 = saturate((bx * aa - ax * ab) / det);
+    }
+
+    // Fits the endpoints to the texels, steps is the number of palette intervals between them.
+    void fit_endpoints(float4 texels[16], float inset_divisor, float steps, uint channel_count, out float4 e0, out float4 e1)
+    {
+        float4 mask = float4(1, 1, 1, channel_count == 4 ? 1 : 0);
+        float4 lo = texels[0];
+        float4 hi = texels[0];
+        for (uint i = 1; i < 16; ++i)
+        {
+            lo = min(lo, texels[i]);
+            hi = max(hi, texels[i]);
+        }
+        float4 inset = (hi - lo) / inset_divisor;
+        e0 = (lo + inset) * mask;
+        e1 = (hi - inset) * mask;
+        for (uint iteration = 0; iteration < p.refine_iterations; ++iteration)
+        {
+            float4 axis = e1 - e0;
+            float length_squared = dot(axis, axis);
+            float weights[16];
+            for (uint i = 0; i < 16; ++i)
+            {
+                float t = length_squared > 0 ? saturate(dot(texels[i] * mask - e0, axis) / length_squared) : 0;
+                weights[i] = round(t * steps) / steps;
+            }
+            refine_endpoints(texels, weights, e0, e1);
+            e0 *= mask;
+            e1 *= mask;
+        }
+    }
+
+    uint pack_565(float3 color)
+    {
+        uint3 q = uint3(round(saturate(color) * float3(31, 63, 31)));
+        return (q.r << 11) | (q.g << 5) | q.b;
+    }
+
+    float3 unpack_565(uint color)
+    {
+        return float3((color >> 11) & 31, (color >> 5) & 63, color & 31) / float3(31, 63, 31);
+    }
+
+    uint2 encode_bc1(float4 texels[16])
+    {
+        float4 e0, e1;
+        fit_endpoints(texels, 16, 3, 3, e0, e1);
+        uint c0 = pack_565(e1.rgb);
+        uint c1 = pack_565(e0.rgb);
+        if (c0 < c1)
+        {
+            uint tmp = c0;
+            c0 = c1;
+            c1 = tmp;
+        }
+        uint2 block = uint2(c0 | (c1 << 16), 0);
+        if (c0 == c1)
+        {
+            return block;
+        }
+        // c0 > c1 selects the opaque four color palette.
+        float3 palette[4] = {unpack_565(c0), unpack_565(c1), float3(0, 0, 0), float3(0, 0, 0)};
+        palette[2] = lerp(palette[0], palette[1], 1.0 / 3.0);
+        palette[3] = lerp(palette[0], palette[1], 2.0 / 3.0);
+        for (uint i = 0; i < 16; ++i)
+        {
+            uint best_index = 0;
+            float best_error = 1e30;
+            for (uint index = 0; index < 4; ++index)
+            {
+                float3 difference = texels[i].rgb - palette[index];
+                float error = dot(difference, difference);
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best_index = index;
+                }
+            }
+            block.y |= best_index << (i * 2);
+        }
+        return block;
+    }
+
+    uint2 encode_bc4(float values[16])
+    {
+        float lo = values[0];
+        float hi = values[0];
+        for (uint i = 1; i < 16; ++i)
+        {
+            lo = min(lo, values[i]);
+            hi = max(hi, values[i]);
+        }
+        uint e0 = uint(round(saturate(hi) * 255));
+        uint e1 = uint(round(saturate(lo) * 255));
+        uint4 block = 0;
+        uint offset = 0;
+        write_bits(block, offset, e0, 8);
+        write_bits(block, offset, e1, 8);
+        for (uint i = 0; i < 16; ++i)
+        {
+            uint index = 0;
+            if (e0 > e1)
+            {
+                // e0 > e1 selects the eight value palette, index 0 is e0, index 1 is e1 and 2 to 7 step from e0 to e1.
+                float t = saturate((values[i] * 255 - e1) / float(e0 - e1));
+                uint level = uint(round(t * 7));
+                index = level == 7 ? 0 : (level == 0 ? 1 : 8 - level);
+            }
+            write_bits(block, offset, index, 3);
+        }
+        return block.xy;
+    }
+
+    uint quantize_bc7_endpoint(float4 color, out uint4 quantized)
+    {
+        float4 value = saturate(color) * 255;
+        uint4 q0 = uint4(clamp(round(value / 2), 0, 127));
+        uint4 q1 = uint4(clamp(round((value - 1) / 2), 0, 127));
+        float4 d0 = value - float4(q0 * 2);
+        float4 d1 = value - float4(q1 * 2 + 1);
+        if (dot(d0, d0) <= dot(d1, d1))
+        {
+            quantized = q0;
+            return 0;
+        }
+        quantized = q1;
+        return 1;
+    }
+
+    // Mode 6: one subset, 7777 endpoints with a p-bit each and 4 bit indices.
+    uint4 encode_bc7(float4 texels[16])
+    {
+        float4 e0, e1;
+        fit_endpoints(texels, 32, 15, 4, e0, e1);
+        uint4 q0, q1;
+        uint p0 = quantize_bc7_endpoint(e0, q0);
+        uint p1 = quantize_bc7_endpoint(e1, q1);
+        float4 d0 = float4(q0 * 2 + p0);
+        float4 d1 = float4(q1 * 2 + p1);
+        float4 axis = d1 - d0;
+        float length_squared = dot(axis, axis);
+        uint indices[16];
+        for (uint i = 0; i < 16; ++i)
+        {
+            float4 texel = texels[i] * 255;
+            float t = length_squared > 0 ? saturate(dot(texel - d0, axis) / length_squared) : 0;
+            uint guess = uint(round(t * 15));
+            uint best_index = guess;
+            float best_error = 1e30;
+            for (uint index = max(guess, 1) - 1; index <= min(guess + 1, 15); ++index)
+            {
+                float4 decoded = floor(((64 - BC7_WEIGHTS[index]) * d0 + BC7_WEIGHTS[index] * d1 + 32) / 64);
+                float4 difference = texel - decoded;
+                float error = dot(difference, difference);
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best_index = index;
+                }
+            }
+            indices[i] = best_index;
+        }
+        // The msb of the first index is implicitly zero.
+        if (indices[0] >= 8)
+        {
+            uint4 tmp_q = q0;
+            q0 = q1;
+            q1 = tmp_q;
+            uint tmp_p = p0;
+            p0 = p1;
+            p1 = tmp_p;
+            for (uint i = 0; i < 16; ++i)
+            {
+                indices[i] = 15 - indices[i];
+            }
+        }
+        uint4 block = 0;
+        uint offset = 0;
+        write_bits(block, offset, 1u << 6, 7);
+        for (uint channel = 0; channel < 4; ++channel)
+        {
+            write_bits(block, offset, q0[channel], 7);
+            write_bits(block, offset, q1[channel], 7);
+        }
+        write_bits(block, offset, p0, 1);
+        write_bits(block, offset, p1, 1);
+        write_bits(block, offset, indices[0], 3);
+        for (uint i = 1; i < 16; ++i)
+        {
+            write_bits(block, offset, indices[i], 4);
+        }
+        return block;
+    }
+
+    [numthreads(8, 8, 1)] void main(uint3 thread_id : SV_DispatchThreadID)
+    {
+        if (thread_id.x >= p.blocks_x || thread_id.y >= p.blocks_y)
+        {
+            return;
+        }
+        uint layer = thread_id.z;
+        Texture2DArray<float4> src = daxa::get_Texture2DArray<float4>(p.src_image_id);
+        float4 texels[16];
+        for (uint y = 0; y < 4; ++y)
+        {
+            for (uint x = 0; x < 4; ++x)
+            {
+                uint2 pos = min(thread_id.xy * 4 + uint2(x, y), uint2(p.src_size_x, p.src_size_y) - 1);
+                float4 texel = src.Load(int4(pos, layer, 0));
+                if (p.convert_to_srgb != 0)
+                {
+                    texel.rgb = linear_to_srgb(texel.rgb);
+                }
+                texels[y * 4 + x] = texel;
+            }
+        }
+        RWByteAddressBuffer dst = daxa::get_RWByteAddressBuffer(p.dst_buffer_id);
+        uint block_index = (layer * p.blocks_y + thread_id.y) * p.blocks_x + thread_id.x;
+        float red[16];
+        float green[16];
+        for (uint i = 0; i < 16; ++i)
+        {
+            red[i] = texels[i].r;
+            green[i] = texels[i].g;
+        }
+        switch (p.mode)
+        {
+        case 0: dst.Store2(p.dst_offset + block_index * 8, encode_bc1(texels)); break;
+        case 1: dst.Store2(p.dst_offset + block_index * 8, encode_bc4(red)); break;
+        case 2: dst.Store4(p.dst_offset + block_index * 16, uint4(encode_bc4(red), encode_bc4(green))); break;
+        default: dst.Store4(p.dst_offset + block_index * 16, encode_bc7(texels)); break;
+        }
+    }
+)--";
+
+namespace daxa
+{
+    static auto block_compression_mode(Format format) -> u32
+    {
+        switch (format)
+        {
+        case Format::BC1_RGB_UNORM_BLOCK:
+        case Format::BC1_RGB_SRGB_BLOCK:
+        case Format::BC1_RGBA_UNORM_BLOCK:
+        case Format::BC1_RGBA_SRGB_BLOCK: return BLOCK_COMPRESSION_MODE_BC1;
+        case Format::BC4_UNORM_BLOCK: return BLOCK_COMPRESSION_MODE_BC4;
+        case Format::BC5_UNORM_BLOCK: return BLOCK_COMPRESSION_MODE_BC5;
+        case Format::BC7_UNORM_BLOCK:
+        case Format::BC7_SRGB_BLOCK: return BLOCK_COMPRESSION_MODE_BC7;
+        default: return ~0u;
+        }
+    }
+
+    static auto is_srgb_format(Format format) -> bool
+    {
+        switch (format)
+        {
+        case Format::R8G8B8A8_SRGB:
+        case Format::B8G8R8A8_SRGB:
+        case Format::BC1_RGB_SRGB_BLOCK:
+        case Format::BC1_RGBA_SRGB_BLOCK:
+        case Format::BC7_SRGB_BLOCK: return true;
+        default: return false;
+        }
+    }
+
+    BlockCompressor::BlockCompressor(BlockCompressorInfo const & info)
+        : ManagedPtr{new ImplBlockCompressor(info)}
+    {
+    }
+
+    BlockCompressor::~BlockCompressor() {}
+
+    void BlockCompressor::record_commands(CommandList & cmd_list, BlockCompressInfo const & info)
+    {
+        auto & impl = *as<ImplBlockCompressor>();
+        impl.record_commands(cmd_list, info);
+    }
+
+    void BlockCompressor::record_task(TaskList & task_list, BlockCompressTaskInfo const & info)
+    {
+        task_list.add_task({
+            .resources = {
+                .images = {
+                    {info.src_image, TaskImageAccess::COMPUTE_SHADER_READ_ONLY},
+                    {info.dst_image, TaskImageAccess::TRANSFER_WRITE},
+                },
+            },
+            .task = [compressor = *this, info](TaskInterface & interf) mutable
+            {
+                auto cmd_list = interf.get_command_list();
+                compressor.record_commands(cmd_list, {
+                    .src_image = interf.get_image(info.src_image),
+                    .src_image_layout = ImageLayout::SHADER_READ_ONLY_OPTIMAL,
+                    .dst_image = interf.get_image(info.dst_image),
+                    .dst_before_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+                    .dst_after_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+                    .slice = info.slice,
+                    .quality = info.quality,
+                });
+            },
+            .debug_name = info.debug_name,
+        });
+    }
+
+    ImplBlockCompressor::ImplBlockCompressor(BlockCompressorInfo const & info)
+        : info{info},
+          // clang-format off
+        encode_pipeline{this->info.pipeline_compiler.create_compute_pipeline({
+            .shader_info = {.source = daxa::ShaderCode{.string = block_compression_hlsl}, .entry_point = "main"},
+            .push_constant_size = sizeof(BlockCompressionPush),
+            .debug_name = this->info.debug_name + " encode pipeline",
+        }).value()}
+    // clang-format on
+    {
+    }
+
+    void ImplBlockCompressor::record_commands(CommandList & cmd_list, BlockCompressInfo const & compress_info)
+    {
+        ImageInfo const src_info = this->info.device.info_image(compress_info.src_image);
+        ImageInfo const dst_info = this->info.device.info_image(compress_info.dst_image);
+        u32 const mode = block_compression_mode(dst_info.format);
+        DAXA_DBG_ASSERT_TRUE_M(mode != ~0u, "block compression destination must be a BC1, BC4_UNORM, BC5_UNORM or BC7 image");
+        DAXA_DBG_ASSERT_TRUE_M(src_info.size == dst_info.size, "block compression source and destination must have the same extent");
+        DAXA_DBG_ASSERT_TRUE_M((src_info.usage & ImageUsageFlagBits::SHADER_READ_ONLY) != 0, "block compression source must have SHADER_READ_ONLY usage");
+        DAXA_DBG_ASSERT_TRUE_M((dst_info.usage & ImageUsageFlagBits::TRANSFER_DST) != 0, "block compression destination must have TRANSFER_DST usage");
+        ImageMipArraySlice const & slice = compress_info.slice;
+        u32 const block_size = (mode == BLOCK_COMPRESSION_MODE_BC1 || mode == BLOCK_COMPRESSION_MODE_BC4) ? 8 : 16;
+        u32 const refine_iterations = compress_info.quality == BlockCompressionQuality::HIGH ? 3 : (compress_info.quality == BlockCompressionQuality::BALANCED ? 1 : 0);
+
+        auto mip_blocks = [&](u32 mip) -> std::array<u32, 2>
+        {
+            return {
+                (std::max(src_info.size[0] >> mip, 1u) + 3) / 4,
+                (std::max(src_info.size[1] >> mip, 1u) + 3) / 4,
+            };
+        };
+        usize scratch_size = 0;
+        for (u32 mip = slice.base_mip_level; mip < slice.base_mip_level + slice.level_count; ++mip)
+        {
+            auto const blocks = mip_blocks(mip);
+            scratch_size += static_cast<usize>(blocks[0]) * blocks[1] * block_size * slice.layer_count;
+        }
+        ensure_scratch_buffer(cmd_list, scratch_size);
+
+        cmd_list.pipeline_barrier_image_transition({
+            .awaited_pipeline_access = AccessConsts::READ_WRITE,
+            .waiting_pipeline_access = AccessConsts::TRANSFER_WRITE,
+            .before_layout = compress_info.dst_before_layout,
+            .after_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+            .image_id = compress_info.dst_image,
+            .image_slice = slice,
+        });
+        // Earlier copies out of the scratch buffer have to finish before it is overwritten.
+        cmd_list.pipeline_barrier({
+            .awaited_pipeline_access = AccessConsts::TRANSFER_READ,
+            .waiting_pipeline_access = AccessConsts::COMPUTE_SHADER_WRITE,
+        });
+        cmd_list.set_pipeline(encode_pipeline);
+        usize offset = 0;
+        for (u32 mip = slice.base_mip_level; mip < slice.base_mip_level + slice.level_count; ++mip)
+        {
+            auto const blocks = mip_blocks(mip);
+            cmd_list.push_constant(BlockCompressionPush{
+                .src_image_id = this->info.device.cached_image_view({
+                    .type = ImageViewType::REGULAR_2D_ARRAY,
+                    .format = src_info.format,
+                    .image = compress_info.src_image,
+                    .slice = {
+                        .base_mip_level = mip,
+                        .level_count = 1,
+                        .base_array_layer = slice.base_array_layer,
+                        .layer_count = slice.layer_count,
+                    },
+                }),
+                .dst_buffer_id = scratch_buffer,
+                .dst_offset = static_cast<u32>(offset),
+                .src_size_x = std::max(src_info.size[0] >> mip, 1u),
+                .src_size_y = std::max(src_info.size[1] >> mip, 1u),
+                .blocks_x = blocks[0],
+                .blocks_y = blocks[1],
+                .mode = mode,
+                .refine_iterations = refine_iterations,
+                .convert_to_srgb = is_srgb_format(src_info.format) && is_srgb_format(dst_info.format) ? 1u : 0u,
+            });
+            cmd_list.dispatch(
+                (blocks[0] + BLOCK_COMPRESSION_WORKGROUP_SIZE - 1) / BLOCK_COMPRESSION_WORKGROUP_SIZE,
+                (blocks[1] + BLOCK_COMPRESSION_WORKGROUP_SIZE - 1) / BLOCK_COMPRESSION_WORKGROUP_SIZE,
+                slice.layer_count);
+            offset += static_cast<usize>(blocks[0]) * blocks[1] * block_size * slice.layer_count;
+        }
+        cmd_list.pipeline_barrier({
+            .awaited_pipeline_access = AccessConsts::COMPUTE_SHADER_WRITE,
+            .waiting_pipeline_access = AccessConsts::TRANSFER_READ,
+        });
+        std::vector<BufferImageCopyRegion> copy_regions = {};
+        offset = 0;
+        for (u32 mip = slice.base_mip_level; mip < slice.base_mip_level + slice.level_count; ++mip)
+        {
+            auto const blocks = mip_blocks(mip);
+            copy_regions.push_back({
+                .buffer_offset = offset,
+                .image_slice = {
+                    .mip_level = mip,
+                    .base_array_layer = slice.base_array_layer,
+                    .layer_count = slice.layer_count,
+                },
+                .image_extent = {std::max(dst_info.size[0] >> mip, 1u), std::max(dst_info.size[1] >> mip, 1u), 1},
+            });
+            offset += static_cast<usize>(blocks[0]) * blocks[1] * block_size * slice.layer_count;
+        }
+        cmd_list.copy_buffer_to_image({
+            .buffer = scratch_buffer,
+            .image = compress_info.dst_image,
+            .image_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+            .regions = copy_regions,
+        });
+        cmd_list.pipeline_barrier_image_transition({
+            .awaited_pipeline_access = AccessConsts::TRANSFER_WRITE,
+            .waiting_pipeline_access = AccessConsts::READ_WRITE,
+            .before_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+            .after_layout = compress_info.dst_after_layout,
+            .image_id = compress_info.dst_image,
+            .image_slice = slice,
+        });
+    }
+
+    void ImplBlockCompressor::ensure_scratch_buffer(CommandList & cmd_list, usize size)
+    {
+        if (scratch_buffer_size >= size)
+        {
+            return;
+        }
+        if (!scratch_buffer.is_empty())
+        {
+            cmd_list.destroy_buffer_deferred(scratch_buffer);
+        }
+        scratch_buffer_size = size;
+        scratch_buffer = this->info.device.create_buffer({
+            .size = static_cast<u32>(scratch_buffer_size),
+            .debug_name = this->info.debug_name + " scratch buffer",
+        });
+    }
+
+    auto ImplBlockCompressor::managed_cleanup() -> bool
+    {
+        return true;
+    }
+
+    ImplBlockCompressor::~ImplBlockCompressor()
+    {
+        if (!scratch_buffer.is_empty())
+        {
+            this->info.device.destroy_buffer(scratch_buffer);
+        }
+    }
+} // namespace daxa
+
+#endif
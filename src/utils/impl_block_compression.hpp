@@ -0,0 +1,21 @@
+#pragma once
+
+#include <daxa/utils/block_compression.hpp>
+
+namespace daxa
+{
+    struct ImplBlockCompressor final : ManagedSharedState
+    {
+        BlockCompressorInfo info;
+        ComputePipeline encode_pipeline;
+        BufferId scratch_buffer = {};
+        usize scratch_buffer_size = {};
+
+        void record_commands(CommandList & cmd_list, BlockCompressInfo const & compress_info);
+        void ensure_scratch_buffer(CommandList & cmd_list, usize size);
+        auto managed_cleanup() -> bool override;
+
+        ImplBlockCompressor(BlockCompressorInfo const & info);
+        virtual ~ImplBlockCompressor() override final;
+    };
+} // namespace daxa
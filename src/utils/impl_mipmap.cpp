@@ -0,0 +1,402 @@
+#if DAXA_BUILT_WITH_UTILS
+
+#include "impl_mipmap.hpp"
+
+#include <algorithm>
+
+// One workgroup reduces a 64x64 tile of the source mip into up to six mips.
+// The last workgroup of every layer to finish then reduces the 64x64 mip 6 texels left in the scratch buffer into up to six more.
+static constexpr daxa::u32 MIPMAP_TILE_SIZE = 64;
+static constexpr daxa::u32 MIPMAP_MAX_PASS_MIPS = 12;
+static constexpr daxa::usize MIPMAP_SCRATCH_LAYER_STRIDE = 16 + MIPMAP_TILE_SIZE * MIPMAP_TILE_SIZE * 16;
+
+struct MipMapReducePush
+{
+    daxa::ImageViewId src_image_id;
+    daxa::ImageViewId dst_image_ids[MIPMAP_MAX_PASS_MIPS];
+    daxa::BufferId scratch_buffer_id;
+    daxa::u32 src_size_x;
+    daxa::u32 src_size_y;
+    daxa::u32 mip_count;
+    daxa::u32 reduction;
+    daxa::u32 workgroup_count;
+};
+
+char const * mipmap_reduce_hlsl = R"--(
+    #include "daxa/daxa.hlsl"
+    DAXA_DEFINE_GET_TEXTURE2DARRAY(float4)
+    DAXA_DEFINE_GET_RWTEXTURE2DARRAY(float4)
+    [[vk::binding(daxa::CONSTANTS::STORAGE_BUFFER_BINDING, 0)]] globallycoherent RWByteAddressBuffer CoherentByteAddressBufferView[];
+
+    struct Push
+    {
+        daxa::ImageViewId src_image_id;
+        daxa::ImageViewId dst_image_ids[12];
+        daxa::BufferId scratch_buffer_id;
+        daxa::u32 src_size_x;
+        daxa::u32 src_size_y;
+        daxa::u32 mip_count;
+        daxa::u32 reduction;
+        daxa::u32 workgroup_count;
+    };
+    [[vk::push_constant]] const Push p;
+
+    #define SCRATCH CoherentByteAddressBufferView[daxa::ID_INDEX_MASK & p.scratch_buffer_id.data]
+    #define SCRATCH_LAYER_STRIDE (16 + 64 * 64 * 16)
+
+    groupshared float4 tile[16][16];
+    groupshared bool is_last_workgroup;
+
+    float4 reduce(float4 a, float4 b, float4 c, float4 d)
+    {
+        if (p.reduction == 1)
+        {
+            return min(min(a, b), min(c, d));
+        }
+        if (p.reduction == 2)
+        {
+            return max(max(a, b), max(c, d));
+        }
+        return (a + b + c + d) * 0.25;
+    }
+
+    uint2 mip_size(uint mip)
+    {
+        return max(uint2(p.src_size_x, p.src_size_y) >> mip, uint2(1, 1));
+    }
+
+    float4 load(uint mip, uint2 pos, uint layer)
+    {
+        pos = min(pos, mip_size(mip) - 1);
+        if (mip == 0)
+        {
+            return daxa::get_Texture2DArray<float4>(p.src_image_id).Load(int4(pos, layer, 0));
+        }
+        return SCRATCH.Load<float4>(layer * SCRATCH_LAYER_STRIDE + 16 + (pos.y * 64 + pos.x) * 16);
+    }
+
+    void store(uint mip, uint2 pos, uint layer, float4 value)
+    {
+        if (mip <= p.mip_count && all(pos < mip_size(mip)))
+        {
+            daxa::get_RWTexture2DArray<float4>(p.dst_image_ids[mip - 1])[uint3(pos, layer)] = value;
+        }
+    }
+
+    // Reduces a 64x64 tile of first_mip into the six following mips. Returns the single texel of the last one in thread 0.
+    float4 reduce_tile(uint first_mip, uint2 tile_index, uint layer, uint thread_index)
+    {
+        uint2 thread_pos = uint2(thread_index % 16, thread_index / 16);
+        uint2 src_base = tile_index * 64 + thread_pos * 4;
+        float4 quad[2][2];
+        for (uint y = 0; y < 2; ++y)
+        {
+            for (uint x = 0; x < 2; ++x)
+            {
+                uint2 src = src_base + uint2(x, y) * 2;
+                float4 value = reduce(
+                    load(first_mip, src + uint2(0, 0), layer),
+                    load(first_mip, src + uint2(1, 0), layer),
+                    load(first_mip, src + uint2(0, 1), layer),
+                    load(first_mip, src + uint2(1, 1), layer));
+                store(first_mip + 1, tile_index * 32 + thread_pos * 2 + uint2(x, y), layer, value);
+                quad[y][x] = value;
+            }
+        }
+        float4 value = reduce(quad[0][0], quad[0][1], quad[1][0], quad[1][1]);
+        store(first_mip + 2, tile_index * 16 + thread_pos, layer, value);
+        tile[thread_pos.y][thread_pos.x] = value;
+        for (uint level = 3; level <= 6; ++level)
+        {
+            uint size = 64 >> level;
+            uint2 pos = uint2(thread_index % size, thread_index / size);
+            bool active = thread_index < size * size;
+            GroupMemoryBarrierWithGroupSync();
+            if (active)
+            {
+                value = reduce(
+                    tile[pos.y * 2 + 0][pos.x * 2 + 0],
+                    tile[pos.y * 2 + 0][pos.x * 2 + 1],
+                    tile[pos.y * 2 + 1][pos.x * 2 + 0],
+                    tile[pos.y * 2 + 1][pos.x * 2 + 1]);
+            }
+            GroupMemoryBarrierWithGroupSync();
+            if (active)
+            {
+                tile[pos.y][pos.x] = value;
+                store(first_mip + level, tile_index * size + pos, layer, value);
+            }
+        }
+        return value;
+    }
+
+    [numthreads(256, 1, 1)] void main(uint3 group_id : SV_GroupID, uint thread_index : SV_GroupIndex)
+    {
+        uint layer = group_id.z;
+        float4 value = reduce_tile(0, group_id.xy, layer, thread_index);
+        if (p.mip_count <= 6)
+        {
+            return;
+        }
+        if (thread_index == 0)
+        {
+            SCRATCH.Store<float4>(layer * SCRATCH_LAYER_STRIDE + 16 + (group_id.y * 64 + group_id.x) * 16, value);
+            DeviceMemoryBarrier();
+            uint finished_workgroups;
+            SCRATCH.InterlockedAdd(layer * SCRATCH_LAYER_STRIDE, 1, finished_workgroups);
+            is_last_workgroup = finished_workgroups == p.workgroup_count - 1;
+        }
+        GroupMemoryBarrierWithGroupSync();
+        if (!is_last_workgroup)
+        {
+            return;
+        }
+        if (thread_index == 0)
+        {
+            SCRATCH.Store(layer * SCRATCH_LAYER_STRIDE, 0);
+        }
+        DeviceMemoryBarrierWithGroupSync();
+        reduce_tile(6, uint2(0, 0), layer, thread_index);
+    }
+)--";
+
+namespace daxa
+{
+    MipMapGenerator::MipMapGenerator(MipMapGeneratorInfo const & info)
+        : ManagedPtr{new ImplMipMapGenerator(info)}
+    {
+    }
+
+    MipMapGenerator::~MipMapGenerator() {}
+
+    void MipMapGenerator::record_commands(CommandList & cmd_list, MipMapGenerateInfo const & info)
+    {
+        auto & impl = *as<ImplMipMapGenerator>();
+        impl.record_commands(cmd_list, info);
+    }
+
+    void MipMapGenerator::record_task(TaskList & task_list, MipMapTaskInfo const & info)
+    {
+        task_list.add_task({
+            .resources = {
+                .images = {
+                    {info.image, TaskImageAccess::COMPUTE_SHADER_READ_WRITE},
+                },
+            },
+            .task = [generator = *this, info](TaskInterface & interf) mutable
+            {
+                auto cmd_list = interf.get_command_list();
+                generator.record_commands(cmd_list, {
+                    .image = interf.get_image(info.image),
+                    .before_layout = ImageLayout::GENERAL,
+                    .after_layout = ImageLayout::GENERAL,
+                    .base_array_layer = info.base_array_layer,
+                    .layer_count = info.layer_count,
+                    .reduction = info.reduction,
+                });
+            },
+            .debug_name = info.debug_name,
+        });
+    }
+
+    ImplMipMapGenerator::ImplMipMapGenerator(MipMapGeneratorInfo const & info)
+        : info{info},
+          // clang-format off
+        reduce_pipeline{this->info.pipeline_compiler.create_compute_pipeline({
+            .shader_info = {.source = daxa::ShaderCode{.string = mipmap_reduce_hlsl}, .entry_point = "main"},
+            .push_constant_size = sizeof(MipMapReducePush),
+            .debug_name = this->info.debug_name + " reduce pipeline",
+        }).value()}
+    // clang-format on
+    {
+    }
+
+    void ImplMipMapGenerator::record_commands(CommandList & cmd_list, MipMapGenerateInfo const & generate_info)
+    {
+        ImageInfo const image_info = this->info.device.info_image(generate_info.image);
+        DAXA_DBG_ASSERT_TRUE_M(image_info.dimensions == 2, "mip map generation only supports 2d images");
+        DAXA_DBG_ASSERT_TRUE_M(generate_info.base_array_layer + generate_info.layer_count <= image_info.array_layer_count, "generated array layers exceed the images array layers");
+
+        ImageUsageFlags const reduce_usage = ImageUsageFlagBits::SHADER_READ_ONLY | ImageUsageFlagBits::SHADER_READ_WRITE;
+        bool const use_reduce = (image_info.usage & reduce_usage) == reduce_usage;
+        Access const work_access = use_reduce ? AccessConsts::COMPUTE_SHADER_READ_WRITE : AccessConsts::TRANSFER_READ_WRITE;
+        ImageMipArraySlice const slice = {
+            .image_aspect = image_info.aspect,
+            .base_mip_level = 0,
+            .level_count = image_info.mip_level_count,
+            .base_array_layer = generate_info.base_array_layer,
+            .layer_count = generate_info.layer_count,
+        };
+
+        cmd_list.pipeline_barrier_image_transition({
+            .awaited_pipeline_access = AccessConsts::READ_WRITE,
+            .waiting_pipeline_access = work_access,
+            .before_layout = generate_info.before_layout,
+            .after_layout = ImageLayout::GENERAL,
+            .image_id = generate_info.image,
+            .image_slice = slice,
+        });
+        if (use_reduce)
+        {
+            record_reduce_passes(cmd_list, image_info, generate_info);
+        }
+        else
+        {
+            record_blits(cmd_list, image_info, generate_info);
+        }
+        cmd_list.pipeline_barrier_image_transition({
+            .awaited_pipeline_access = work_access,
+            .waiting_pipeline_access = AccessConsts::READ_WRITE,
+            .before_layout = ImageLayout::GENERAL,
+            .after_layout = generate_info.after_layout,
+            .image_id = generate_info.image,
+            .image_slice = slice,
+        });
+    }
+
+    void ImplMipMapGenerator::record_reduce_passes(CommandList & cmd_list, ImageInfo const & image_info, MipMapGenerateInfo const & generate_info)
+    {
+        auto mip_view = [&](u32 mip) -> ImageViewId
+        {
+            return this->info.device.cached_image_view({
+                .type = ImageViewType::REGULAR_2D_ARRAY,
+                .format = image_info.format,
+                .image = generate_info.image,
+                .slice = {
+                    .image_aspect = image_info.aspect,
+                    .base_mip_level = mip,
+                    .level_count = 1,
+                    .base_array_layer = generate_info.base_array_layer,
+                    .layer_count = generate_info.layer_count,
+                },
+            });
+        };
+
+        cmd_list.set_pipeline(reduce_pipeline);
+        u32 src_mip = 0;
+        while (src_mip + 1 < image_info.mip_level_count)
+        {
+            u32 const src_size_x = std::max(image_info.size[0] >> src_mip, 1u);
+            u32 const src_size_y = std::max(image_info.size[1] >> src_mip, 1u);
+            // The second half of a pass reduces one mip 6 texel per workgroup, so it can only cover 4096x4096 sources.
+            u32 const max_pass_mips = std::max(src_size_x, src_size_y) > MIPMAP_TILE_SIZE * MIPMAP_TILE_SIZE ? MIPMAP_MAX_PASS_MIPS / 2 : MIPMAP_MAX_PASS_MIPS;
+            u32 const mip_count = std::min(image_info.mip_level_count - 1 - src_mip, max_pass_mips);
+            u32 const workgroups_x = (src_size_x + MIPMAP_TILE_SIZE - 1) / MIPMAP_TILE_SIZE;
+            u32 const workgroups_y = (src_size_y + MIPMAP_TILE_SIZE - 1) / MIPMAP_TILE_SIZE;
+
+            bool const uses_scratch = mip_count > MIPMAP_MAX_PASS_MIPS / 2;
+            if (uses_scratch)
+            {
+                ensure_scratch_buffer(cmd_list, MIPMAP_SCRATCH_LAYER_STRIDE * generate_info.layer_count);
+            }
+            // Earlier passes may still be reading the previous source mip or the scratch buffer.
+            if (src_mip != 0 || uses_scratch)
+            {
+                cmd_list.pipeline_barrier({
+                    .awaited_pipeline_access = AccessConsts::COMPUTE_SHADER_WRITE,
+                    .waiting_pipeline_access = AccessConsts::COMPUTE_SHADER_READ_WRITE,
+                });
+            }
+
+            MipMapReducePush push = {
+                .src_image_id = mip_view(src_mip),
+                .dst_image_ids = {},
+                .scratch_buffer_id = scratch_buffer,
+                .src_size_x = src_size_x,
+                .src_size_y = src_size_y,
+                .mip_count = mip_count,
+                .reduction = static_cast<u32>(generate_info.reduction),
+                .workgroup_count = workgroups_x * workgroups_y,
+            };
+            for (u32 i = 0; i < MIPMAP_MAX_PASS_MIPS; ++i)
+            {
+                // Unused slots still need a valid id, the shader never writes to them.
+                push.dst_image_ids[i] = i < mip_count ? mip_view(src_mip + 1 + i) : push.dst_image_ids[0];
+            }
+            cmd_list.push_constant(push);
+            cmd_list.dispatch(workgroups_x, workgroups_y, generate_info.layer_count);
+            src_mip += mip_count;
+        }
+    }
+
+    void ImplMipMapGenerator::record_blits(CommandList & cmd_list, ImageInfo const & image_info, MipMapGenerateInfo const & generate_info)
+    {
+        DAXA_DBG_ASSERT_TRUE_M(generate_info.reduction == MipMapReduction::AVERAGE, "images without shader read and write usage only support average mip map reduction");
+        for (u32 mip = 1; mip < image_info.mip_level_count; ++mip)
+        {
+            if (mip > 1)
+            {
+                cmd_list.pipeline_barrier({
+                    .awaited_pipeline_access = AccessConsts::TRANSFER_WRITE,
+                    .waiting_pipeline_access = AccessConsts::TRANSFER_READ,
+                });
+            }
+            i32 const src_size_x = static_cast<i32>(std::max(image_info.size[0] >> (mip - 1), 1u));
+            i32 const src_size_y = static_cast<i32>(std::max(image_info.size[1] >> (mip - 1), 1u));
+            cmd_list.blit_image_to_image({
+                .src_image = generate_info.image,
+                .src_image_layout = ImageLayout::GENERAL,
+                .dst_image = generate_info.image,
+                .dst_image_layout = ImageLayout::GENERAL,
+                .src_slice = {
+                    .image_aspect = image_info.aspect,
+                    .mip_level = mip - 1,
+                    .base_array_layer = generate_info.base_array_layer,
+                    .layer_count = generate_info.layer_count,
+                },
+                .src_offsets = {{{0, 0, 0}, {src_size_x, src_size_y, 1}}},
+                .dst_slice = {
+                    .image_aspect = image_info.aspect,
+                    .mip_level = mip,
+                    .base_array_layer = generate_info.base_array_layer,
+                    .layer_count = generate_info.layer_count,
+                },
+                .dst_offsets = {{{0, 0, 0}, {std::max(src_size_x / 2, 1), std::max(src_size_y / 2, 1), 1}}},
+                .filter = Filter::LINEAR,
+            });
+        }
+    }
+
+    void ImplMipMapGenerator::ensure_scratch_buffer(CommandList & cmd_list, usize size)
+    {
+        if (scratch_buffer_size >= size)
+        {
+            return;
+        }
+        if (!scratch_buffer.is_empty())
+        {
+            cmd_list.destroy_buffer_deferred(scratch_buffer);
+        }
+        scratch_buffer_size = size;
+        scratch_buffer = this->info.device.create_buffer({
+            .size = static_cast<u32>(scratch_buffer_size),
+            .debug_name = this->info.debug_name + " scratch buffer",
+        });
+        // The workgroup counters must start out at zero, the last workgroup of each pass resets them afterwards.
+        cmd_list.clear_buffer({
+            .buffer = scratch_buffer,
+            .offset = 0,
+            .size = scratch_buffer_size,
+            .clear_value = 0,
+        });
+        cmd_list.pipeline_barrier({
+            .awaited_pipeline_access = AccessConsts::TRANSFER_WRITE,
+            .waiting_pipeline_access = AccessConsts::COMPUTE_SHADER_READ_WRITE,
+        });
+    }
+
+    auto ImplMipMapGenerator::managed_cleanup() -> bool
+    {
+        return true;
+    }
+
+    ImplMipMapGenerator::~ImplMipMapGenerator()
+    {
+        if (!scratch_buffer.is_empty())
+        {
+            this->info.device.destroy_buffer(scratch_buffer);
+        }
+    }
+} // namespace daxa
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <daxa/utils/mipmap.hpp>
+
+namespace daxa
+{
+    struct ImplMipMapGenerator final : ManagedSharedState
+    {
+        MipMapGeneratorInfo info;
+        ComputePipeline reduce_pipeline;
+        BufferId scratch_buffer = {};
+        usize scratch_buffer_size = {};
+
+        void record_commands(CommandList & cmd_list, MipMapGenerateInfo const & generate_info);
+        void record_reduce_passes(CommandList & cmd_list, ImageInfo const & image_info, MipMapGenerateInfo const & generate_info);
+        void record_blits(CommandList & cmd_list, ImageInfo const & image_info, MipMapGenerateInfo const & generate_info);
+        void ensure_scratch_buffer(CommandList & cmd_list, usize size);
+        auto managed_cleanup() -> bool override;
+
+        ImplMipMapGenerator(MipMapGeneratorInfo const & info);
+        virtual ~ImplMipMapGenerator() override final;
+    };
+} // namespace daxa
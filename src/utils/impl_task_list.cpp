@@ -41,6 +41,7 @@ namespace daxa
         case TaskBufferAccess::TRANSFER_WRITE: return std::string_view{"TRANSFER_WRITE"};
         case TaskBufferAccess::HOST_TRANSFER_READ: return std::string_view{"HOST_TRANSFER_READ"};
         case TaskBufferAccess::HOST_TRANSFER_WRITE: return std::string_view{"HOST_TRANSFER_WRITE"};
+        case TaskBufferAccess::INDIRECT_COMMAND_READ: return std::string_view{"INDIRECT_COMMAND_READ"};
         default: DAXA_DBG_ASSERT_TRUE_M(false, "unreachable");
         }
         return "invalid";
@@ -187,6 +188,7 @@ namespace daxa
             .latest_access_task_index = task_index,
             .fetch_callback = info.fetch_callback,
             .slice = info.slice,
+            .discards_initial_contents = info.last_layout == ImageLayout::UNDEFINED,
             .debug_name = info.debug_name,
         });
 
@@ -205,6 +207,10 @@ namespace daxa
     {
         auto & impl = *as<ImplTaskList>();
         DAXA_DBG_ASSERT_TRUE_M(!impl.compiled, "can only record to uncompleted task list");
+        for (auto const & [task_image_id, t_access] : info.resources.images)
+        {
+            impl.slot(task_image_id).usage |= impl.task_image_access_to_usage(t_access);
+        }
         impl.tasks.push_back({
             .event_variant = ImplGenericTask{
                 .info = {
@@ -357,6 +363,18 @@ namespace daxa
         return impl.impl_task_images[image.index].latest_layout;
     }
 
+    auto TaskList::image_usage(TaskImageId image) -> ImageUsageFlags
+    {
+        auto & impl = *as<ImplTaskList>();
+        auto const & task_image = impl.slot(image);
+        ImageUsageFlags const attachment_usages = ImageUsageFlagBits::COLOR_ATTACHMENT | ImageUsageFlagBits::DEPTH_STENCIL_ATTACHMENT;
+        if (task_image.discards_initial_contents && task_image.usage != 0 && (task_image.usage & ~attachment_usages) == 0)
+        {
+            return task_image.usage | ImageUsageFlagBits::TRANSIENT_ATTACHMENT;
+        }
+        return task_image.usage;
+    }
+
     void TaskRuntime::execute_task(TaskEvent & task_event, usize task_index)
     {
         DAXA_ONLY_IF_TASK_LIST_DEBUG(std::cout << "execute task (index: " << task_index << ")");
@@ -408,8 +426,8 @@ namespace daxa
                 ImageViewInfo image_view_info = this->current_device.info_image_view(image_view_id);
                 image_view_info.slice = impl_task_image.slice;
 
-                // TODO(pahrens): This leaks. The view is never destroyed. Make sure the runtime kills it in the end of execution.
-                image_view_id = this->current_device.create_image_view(image_view_info);
+                // The view is owned by the device and destroyed together with the image.
+                image_view_id = this->current_device.cached_image_view(image_view_info);
             }
 
             this->runtime_images.push_back(RuntimeTaskImage{
@@ -509,6 +527,34 @@ namespace daxa
         return {};
     }
 
+    auto ImplTaskList::task_image_access_to_usage(TaskImageAccess const & access) -> ImageUsageFlags
+    {
+        switch (access)
+        {
+        case TaskImageAccess::NONE: return {};
+        case TaskImageAccess::SHADER_READ_ONLY:
+        case TaskImageAccess::VERTEX_SHADER_READ_ONLY:
+        case TaskImageAccess::TESSELLATION_CONTROL_SHADER_READ_ONLY:
+        case TaskImageAccess::TESSELLATION_EVALUATION_SHADER_READ_ONLY:
+        case TaskImageAccess::GEOMETRY_SHADER_READ_ONLY:
+        case TaskImageAccess::FRAGMENT_SHADER_READ_ONLY:
+        case TaskImageAccess::COMPUTE_SHADER_READ_ONLY: return ImageUsageFlagBits::SHADER_READ_ONLY;
+        case TaskImageAccess::TRANSFER_READ: return ImageUsageFlagBits::TRANSFER_SRC;
+        case TaskImageAccess::TRANSFER_WRITE: return ImageUsageFlagBits::TRANSFER_DST;
+        case TaskImageAccess::COLOR_ATTACHMENT:
+        case TaskImageAccess::RESOLVE_WRITE: return ImageUsageFlagBits::COLOR_ATTACHMENT;
+        case TaskImageAccess::DEPTH_ATTACHMENT:
+        case TaskImageAccess::STENCIL_ATTACHMENT:
+        case TaskImageAccess::DEPTH_STENCIL_ATTACHMENT:
+        case TaskImageAccess::DEPTH_ATTACHMENT_READ_ONLY:
+        case TaskImageAccess::STENCIL_ATTACHMENT_READ_ONLY:
+        case TaskImageAccess::DEPTH_STENCIL_ATTACHMENT_READ_ONLY: return ImageUsageFlagBits::DEPTH_STENCIL_ATTACHMENT;
+        // Swapchain images are never transient.
+        case TaskImageAccess::PRESENT: return ImageUsageFlagBits::COLOR_ATTACHMENT | ImageUsageFlagBits::TRANSFER_DST;
+        default: return ImageUsageFlagBits::SHADER_READ_WRITE;
+        }
+    }
+
     auto ImplTaskList::task_buffer_access_to_access(TaskBufferAccess const & access) -> Access
     {
         switch (access)
@@ -539,6 +585,7 @@ namespace daxa
         case TaskBufferAccess::TRANSFER_WRITE: return {PipelineStageFlagBits::TRANSFER, AccessTypeFlagBits::WRITE};
         case TaskBufferAccess::HOST_TRANSFER_READ: return {PipelineStageFlagBits::HOST, AccessTypeFlagBits::READ};
         case TaskBufferAccess::HOST_TRANSFER_WRITE: return {PipelineStageFlagBits::HOST, AccessTypeFlagBits::WRITE};
+        case TaskBufferAccess::INDIRECT_COMMAND_READ: return {PipelineStageFlagBits::DRAW_INDIRECT, AccessTypeFlagBits::READ};
         default: DAXA_DBG_ASSERT_TRUE_M(false, "unreachable");
         }
         return {};
@@ -39,6 +39,9 @@ namespace daxa
         usize latest_access_task_index = {};
         CreateTaskImageCallback fetch_callback = {};
         ImageMipArraySlice slice = {};
+        // Accumulated over all recorded accesses.
+        ImageUsageFlags usage = {};
+        bool discards_initial_contents = {};
         std::string debug_name = {};
     };
 
@@ -138,6 +141,7 @@ namespace daxa
 
         auto task_image_access_to_layout_access(TaskImageAccess const & access) -> std::tuple<ImageLayout, Access>;
         auto task_buffer_access_to_access(TaskBufferAccess const & access) -> Access;
+        auto task_image_access_to_usage(TaskImageAccess const & access) -> ImageUsageFlags;
         auto compute_needed_barrier(Access const & previous_access, Access const & new_access) -> std::optional<TaskPipelineBarrier>;
 
         void execute_barriers();
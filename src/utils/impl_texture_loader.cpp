@@ -0,0 +1,456 @@
+#if DAXA_BUILT_WITH_UTILS
+
+#include <daxa/utils/texture_loader.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include "Windows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace daxa
+{
+    static inline constexpr usize TEXTURE_STAGING_REGION_ALIGNMENT = 16;
+
+    struct MappedTextureFile
+    {
+        u8 const * data = {};
+        usize size = {};
+#if defined(_WIN32)
+        HANDLE file_handle = INVALID_HANDLE_VALUE;
+        HANDLE mapping_handle = {};
+#endif
+
+        MappedTextureFile(std::filesystem::path const & path)
+        {
+#if defined(_WIN32)
+            file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file_handle == INVALID_HANDLE_VALUE)
+            {
+                return;
+            }
+            LARGE_INTEGER file_size = {};
+            if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0)
+            {
+                return;
+            }
+            mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_handle == nullptr)
+            {
+                return;
+            }
+            data = static_cast<u8 const *>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+            size = data != nullptr ? static_cast<usize>(file_size.QuadPart) : 0;
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd == -1)
+            {
+                return;
+            }
+            struct stat file_stat = {};
+            if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0)
+            {
+                void * mapping = mmap(nullptr, static_cast<usize>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED)
+                {
+                    // The payload is read front to back exactly once.
+                    madvise(mapping, static_cast<usize>(file_stat.st_size), MADV_SEQUENTIAL);
+                    data = static_cast<u8 const *>(mapping);
+                    size = static_cast<usize>(file_stat.st_size);
+                }
+            }
+            close(fd);
+#endif
+        }
+
+        MappedTextureFile(MappedTextureFile const &) = delete;
+        MappedTextureFile & operator=(MappedTextureFile const &) = delete;
+
+        ~MappedTextureFile()
+        {
+#if defined(_WIN32)
+            if (data != nullptr)
+            {
+                UnmapViewOfFile(data);
+            }
+            if (mapping_handle != nullptr)
+            {
+                CloseHandle(mapping_handle);
+            }
+            if (file_handle != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(file_handle);
+            }
+#else
+            if (data != nullptr)
+            {
+                munmap(const_cast<u8 *>(data), size);
+            }
+#endif
+        }
+
+        auto read_u32(usize offset) const -> u32
+        {
+            u32 value = {};
+            std::memcpy(&value, data + offset, sizeof(u32));
+            return value;
+        }
+
+        auto read_u64(usize offset) const -> u64
+        {
+            u64 value = {};
+            std::memcpy(&value, data + offset, sizeof(u64));
+            return value;
+        }
+    };
+
+    struct TextureRegion
+    {
+        usize file_offset = {};
+        usize size = {};
+        u32 mip_level = {};
+        u32 base_array_layer = {};
+        u32 layer_count = {};
+    };
+
+    struct TextureDescription
+    {
+        Format format = Format::UNDEFINED;
+        u32 size_x = {};
+        u32 size_y = {};
+        u32 mip_level_count = {};
+        u32 array_layer_count = {};
+        std::vector<TextureRegion> regions = {};
+    };
+
+    static auto mip_byte_size(TexelBlockInfo const & block, u32 size_x, u32 size_y, u32 mip_level) -> usize
+    {
+        usize const blocks_x = (std::max(size_x >> mip_level, 1u) + block.extent_x - 1) / block.extent_x;
+        usize const blocks_y = (std::max(size_y >> mip_level, 1u) + block.extent_y - 1) / block.extent_y;
+        return blocks_x * blocks_y * block.byte_size;
+    }
+
+    static auto dxgi_to_format(u32 dxgi_format) -> Format
+    {
+        switch (dxgi_format)
+        {
+        case 2: return Format::R32G32B32A32_SFLOAT;
+        case 10: return Format::R16G16B16A16_SFLOAT;
+        case 11: return Format::R16G16B16A16_UNORM;
+        case 16: return Format::R32G32_SFLOAT;
+        case 28: return Format::R8G8B8A8_UNORM;
+        case 29: return Format::R8G8B8A8_SRGB;
+        case 34: return Format::R16G16_SFLOAT;
+        case 41: return Format::R32_SFLOAT;
+        case 49: return Format::R8G8_UNORM;
+        case 54: return Format::R16_SFLOAT;
+        case 61: return Format::R8_UNORM;
+        case 71: return Format::BC1_RGBA_UNORM_BLOCK;
+        case 72: return Format::BC1_RGBA_SRGB_BLOCK;
+        case 74: return Format::BC2_UNORM_BLOCK;
+        case 75: return Format::BC2_SRGB_BLOCK;
+        case 77: return Format::BC3_UNORM_BLOCK;
+        case 78: return Format::BC3_SRGB_BLOCK;
+        case 80: return Format::BC4_UNORM_BLOCK;
+        case 81: return Format::BC4_SNORM_BLOCK;
+        case 83: return Format::BC5_UNORM_BLOCK;
+        case 84: return Format::BC5_SNORM_BLOCK;
+        case 87: return Format::B8G8R8A8_UNORM;
+        case 91: return Format::B8G8R8A8_SRGB;
+        case 95: return Format::BC6H_UFLOAT_BLOCK;
+        case 96: return Format::BC6H_SFLOAT_BLOCK;
+        case 98: return Format::BC7_UNORM_BLOCK;
+        case 99: return Format::BC7_SRGB_BLOCK;
+        default: return Format::UNDEFINED;
+        }
+    }
+
+    static constexpr auto four_cc(char const (&code)[5]) -> u32
+    {
+        return static_cast<u32>(code[0]) | (static_cast<u32>(code[1]) << 8) | (static_cast<u32>(code[2]) << 16) | (static_cast<u32>(code[3]) << 24);
+    }
+
+    static auto parse_ktx2(MappedTextureFile const & file) -> Result<TextureDescription>
+    {
+        static constexpr usize KTX2_HEADER_SIZE = 80;
+        static constexpr usize KTX2_LEVEL_INDEX_ENTRY_SIZE = 24;
+        if (file.size < KTX2_HEADER_SIZE)
+        {
+            return ResultErr{"ktx2 file is truncated"};
+        }
+        if (file.read_u32(28) > 1)
+        {
+            return ResultErr{"3d ktx2 textures are not supported"};
+        }
+        if (file.read_u32(44) != 0)
+        {
+            return ResultErr{"supercompressed ktx2 files are not supported"};
+        }
+        TextureDescription description = {
+            .format = static_cast<Format>(file.read_u32(12)),
+            .size_x = file.read_u32(20),
+            .size_y = std::max(file.read_u32(24), 1u),
+            .mip_level_count = std::max(file.read_u32(40), 1u),
+            .array_layer_count = std::max(file.read_u32(32), 1u) * std::max(file.read_u32(36), 1u),
+        };
+        TexelBlockInfo const block = texel_block_info(description.format);
+        if (block.byte_size == 0)
+        {
+            return ResultErr{"unsupported ktx2 format"};
+        }
+        if (KTX2_HEADER_SIZE + description.mip_level_count * KTX2_LEVEL_INDEX_ENTRY_SIZE > file.size)
+        {
+            return ResultErr{"ktx2 file is truncated"};
+        }
+        for (u32 mip = 0; mip < description.mip_level_count; ++mip)
+        {
+            usize const entry = KTX2_HEADER_SIZE + mip * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+            TextureRegion region = {
+                .file_offset = static_cast<usize>(file.read_u64(entry + 0)),
+                .size = static_cast<usize>(file.read_u64(entry + 8)),
+                .mip_level = mip,
+                .base_array_layer = 0,
+                .layer_count = description.array_layer_count,
+            };
+            if (region.size != mip_byte_size(block, description.size_x, description.size_y, mip) * description.array_layer_count)
+            {
+                return ResultErr{"ktx2 level size does not match its format and extent"};
+            }
+            // The level index is read from the file, so the offset may be arbitrarily large.
+            if (region.file_offset > file.size || region.size > file.size - region.file_offset)
+            {
+                return ResultErr{"ktx2 file is truncated"};
+            }
+            description.regions.push_back(region);
+        }
+        return description;
+    }
+
+    static auto parse_dds(MappedTextureFile const & file) -> Result<TextureDescription>
+    {
+        static constexpr usize DDS_HEADER_END = 128;
+        static constexpr usize DDS_DX10_HEADER_END = 148;
+        static constexpr u32 DDSD_MIPMAPCOUNT = 0x20000;
+        static constexpr u32 DDPF_FOURCC = 0x4;
+        static constexpr u32 DDPF_RGB = 0x40;
+        static constexpr u32 DDSCAPS2_CUBEMAP = 0x200;
+        static constexpr u32 DDSCAPS2_VOLUME = 0x200000;
+        static constexpr u32 DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+        static constexpr u32 DDS_DIMENSION_TEXTURE3D = 4;
+        if (file.size < DDS_HEADER_END)
+        {
+            return ResultErr{"dds file is truncated"};
+        }
+        u32 const flags = file.read_u32(8);
+        u32 const pixel_format_flags = file.read_u32(80);
+        u32 const pixel_format_four_cc = file.read_u32(84);
+        u32 const caps2 = file.read_u32(112);
+        TextureDescription description = {
+            .size_x = file.read_u32(16),
+            .size_y = std::max(file.read_u32(12), 1u),
+            .mip_level_count = (flags & DDSD_MIPMAPCOUNT) != 0 ? std::max(file.read_u32(28), 1u) : 1u,
+            .array_layer_count = (caps2 & DDSCAPS2_CUBEMAP) != 0 ? 6u : 1u,
+        };
+        usize data_offset = DDS_HEADER_END;
+        if ((caps2 & DDSCAPS2_VOLUME) != 0)
+        {
+            return ResultErr{"3d dds textures are not supported"};
+        }
+        if ((pixel_format_flags & DDPF_FOURCC) != 0 && pixel_format_four_cc == four_cc("DX10"))
+        {
+            if (file.size < DDS_DX10_HEADER_END)
+            {
+                return ResultErr{"dds file is truncated"};
+            }
+            if (file.read_u32(132) == DDS_DIMENSION_TEXTURE3D)
+            {
+                return ResultErr{"3d dds textures are not supported"};
+            }
+            description.format = dxgi_to_format(file.read_u32(128));
+            u32 const faces = (file.read_u32(136) & DDS_RESOURCE_MISC_TEXTURECUBE) != 0 ? 6u : 1u;
+            description.array_layer_count = std::max(file.read_u32(140), 1u) * faces;
+            data_offset = DDS_DX10_HEADER_END;
+        }
+        else if ((pixel_format_flags & DDPF_FOURCC) != 0)
+        {
+            switch (pixel_format_four_cc)
+            {
+            case four_cc("DXT1"): description.format = Format::BC1_RGBA_UNORM_BLOCK; break;
+            case four_cc("DXT2"):
+            case four_cc("DXT3"): description.format = Format::BC2_UNORM_BLOCK; break;
+            case four_cc("DXT4"):
+            case four_cc("DXT5"): description.format = Format::BC3_UNORM_BLOCK; break;
+            case four_cc("ATI1"):
+            case four_cc("BC4U"): description.format = Format::BC4_UNORM_BLOCK; break;
+            case four_cc("BC4S"): description.format = Format::BC4_SNORM_BLOCK; break;
+            case four_cc("ATI2"):
+            case four_cc("BC5U"): description.format = Format::BC5_UNORM_BLOCK; break;
+            case four_cc("BC5S"): description.format = Format::BC5_SNORM_BLOCK; break;
+            default: break;
+            }
+        }
+        else if ((pixel_format_flags & DDPF_RGB) != 0 && file.read_u32(88) == 32)
+        {
+            u32 const red_mask = file.read_u32(92);
+            if (red_mask == 0x000000ff)
+            {
+                description.format = Format::R8G8B8A8_UNORM;
+            }
+            else if (red_mask == 0x00ff0000)
+            {
+                description.format = Format::B8G8R8A8_UNORM;
+            }
+        }
+        TexelBlockInfo const block = texel_block_info(description.format);
+        if (block.byte_size == 0)
+        {
+            return ResultErr{"unsupported dds format"};
+        }
+        // Dds stores the full mip chain of each layer before the next layer.
+        for (u32 layer = 0; layer < description.array_layer_count; ++layer)
+        {
+            for (u32 mip = 0; mip < description.mip_level_count; ++mip)
+            {
+                TextureRegion region = {
+                    .file_offset = data_offset,
+                    .size = mip_byte_size(block, description.size_x, description.size_y, mip),
+                    .mip_level = mip,
+                    .base_array_layer = layer,
+                    .layer_count = 1,
+                };
+                if (region.file_offset > file.size || region.size > file.size - region.file_offset)
+                {
+                    return ResultErr{"dds file is truncated"};
+                }
+                data_offset += region.size;
+                description.regions.push_back(region);
+            }
+        }
+        return description;
+    }
+
+    auto load_texture(Device & device, CommandList & cmd_list, TextureLoadInfo const & info) -> Result<ImageId>
+    {
+        static constexpr u8 KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+        static constexpr u32 DDS_MAGIC = 0x20534444;
+
+        MappedTextureFile file{info.path};
+        if (file.data == nullptr)
+        {
+            return ResultErr{std::string("could not map texture file \"") + info.path.string() + "\""};
+        }
+        Result<TextureDescription> parse_result = ResultErr{"unknown texture file format"};
+        if (file.size >= sizeof(KTX2_IDENTIFIER) && std::memcmp(file.data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0)
+        {
+            parse_result = parse_ktx2(file);
+        }
+        else if (file.size >= sizeof(u32) && file.read_u32(0) == DDS_MAGIC)
+        {
+            parse_result = parse_dds(file);
+        }
+        if (parse_result.is_err())
+        {
+            return ResultErr{parse_result.message() + " in \"" + info.path.string() + "\""};
+        }
+        TextureDescription const & description = parse_result.value();
+        if (description.size_x == 0)
+        {
+            return ResultErr{std::string("texture file \"") + info.path.string() + "\" has an extent of zero"};
+        }
+
+        // Buffer offsets of image copies have to be multiples of the texel block size and of 4, see image_staging_layout.
+        usize const region_alignment = std::lcm(std::lcm(TEXTURE_STAGING_REGION_ALIGNMENT, usize{texel_block_info(description.format).byte_size}), usize{4});
+        usize staging_size = 0;
+        for (auto const & region : description.regions)
+        {
+            staging_size = (staging_size + region_alignment - 1) / region_alignment * region_alignment;
+            staging_size += region.size;
+        }
+        if (staging_size > std::numeric_limits<u32>::max())
+        {
+            return ResultErr{std::string("texture file \"") + info.path.string() + "\" is too large to be staged in one buffer"};
+        }
+
+        ImageId image = device.create_image({
+            .dimensions = 2,
+            .format = description.format,
+            .size = {description.size_x, description.size_y, 1},
+            .mip_level_count = description.mip_level_count,
+            .array_layer_count = description.array_layer_count,
+            .usage = info.usage | ImageUsageFlagBits::TRANSFER_DST,
+            .debug_name = info.debug_name,
+        });
+        BufferId staging_buffer = device.create_buffer({
+            .memory_flags = MemoryFlagBits::HOST_ACCESS_SEQUENTIAL_WRITE | MemoryFlagBits::MAPPED,
+            .size = static_cast<u32>(staging_size),
+            .debug_name = info.debug_name + " staging buffer",
+        });
+        auto * staging_data = static_cast<u8 *>(device.buffer_host_address(staging_buffer));
+        DAXA_DBG_ASSERT_TRUE_M(staging_data != nullptr, "texture staging buffer must be host visible");
+
+        ImageMipArraySlice const full_slice = {
+            .base_mip_level = 0,
+            .level_count = description.mip_level_count,
+            .base_array_layer = 0,
+            .layer_count = description.array_layer_count,
+        };
+        cmd_list.pipeline_barrier_image_transition({
+            .waiting_pipeline_access = AccessConsts::TRANSFER_WRITE,
+            .before_layout = ImageLayout::UNDEFINED,
+            .after_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+            .image_id = image,
+            .image_slice = full_slice,
+        });
+        std::vector<BufferImageCopyRegion> copy_regions = {};
+        copy_regions.reserve(description.regions.size());
+        usize staging_offset = 0;
+        for (auto const & region : description.regions)
+        {
+            staging_offset = (staging_offset + region_alignment - 1) / region_alignment * region_alignment;
+            std::memcpy(staging_data + staging_offset, file.data + region.file_offset, region.size);
+            copy_regions.push_back({
+                .buffer_offset = staging_offset,
+                .image_slice = {
+                    .mip_level = region.mip_level,
+                    .base_array_layer = region.base_array_layer,
+                    .layer_count = region.layer_count,
+                },
+                .image_extent = {
+                    std::max(description.size_x >> region.mip_level, 1u),
+                    std::max(description.size_y >> region.mip_level, 1u),
+                    1,
+                },
+            });
+            staging_offset += region.size;
+        }
+        cmd_list.copy_buffer_to_image({
+            .buffer = staging_buffer,
+            .image = image,
+            .image_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+            .regions = copy_regions,
+        });
+        cmd_list.pipeline_barrier_image_transition({
+            .awaited_pipeline_access = AccessConsts::TRANSFER_WRITE,
+            .waiting_pipeline_access = AccessConsts::READ,
+            .before_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+            .after_layout = info.final_layout,
+            .image_id = image,
+            .image_slice = full_slice,
+        });
+        cmd_list.destroy_buffer_deferred(staging_buffer);
+        return image;
+    }
+} // namespace daxa
+
+#endif
@@ -518,22 +518,20 @@ struct RenderableVoxelWorld
             },
         });
 
-        for (usize i = 0; i < texture_names.size(); ++i)
-        {
-            cmd_list.copy_buffer_to_image({
-                .buffer = texture_staging_buffer,
-                .buffer_offset = i * image_size,
-                .image = atlas_texture_array,
-                .image_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
-                .image_slice = {
-                    .mip_level = 0,
-                    .base_array_layer = static_cast<u32>(i),
-                    .layer_count = 1,
-                },
-                .image_offset = {0, 0, 0},
-                .image_extent = {16, 16, 1},
-            });
-        }
+        // The layers are tightly packed in the staging buffer, so a single region uploads all of them.
+        cmd_list.copy_buffer_to_image({
+            .buffer = texture_staging_buffer,
+            .buffer_offset = 0,
+            .image = atlas_texture_array,
+            .image_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+            .image_slice = {
+                .mip_level = 0,
+                .base_array_layer = 0,
+                .layer_count = static_cast<u32>(texture_names.size()),
+            },
+            .image_offset = {0, 0, 0},
+            .image_extent = {16, 16, 1},
+        });
 
         // cmd_list.pipeline_barrier_image_transition({
         //     .awaited_pipeline_access = daxa::AccessConsts::TRANSFER_READ,
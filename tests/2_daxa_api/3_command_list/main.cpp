@@ -1,5 +1,6 @@
 #include <daxa/daxa.hpp>
 #include <iostream>
+#include <new>
 
 struct App
 {
@@ -187,6 +188,75 @@ namespace tests
         app.device.collect_garbage();
     }
 
+    void import_host_buffer(App & app)
+    {
+        // Imported host memory has to be aligned to minImportedHostPointerAlignment, which is at most 64KiB on common drivers.
+        constexpr usize HOST_ALIGNMENT = 1 << 16;
+        constexpr usize HOST_SIZE = 1 << 16;
+        auto * host_memory = static_cast<f32 *>(::operator new(HOST_SIZE, std::align_val_t{HOST_ALIGNMENT}));
+        for (usize i = 0; i < HOST_SIZE / sizeof(f32); ++i)
+        {
+            host_memory[i] = static_cast<f32>(i);
+        }
+
+        auto import_result = app.device.import_host_buffer({
+            .host_address = host_memory,
+            .size = HOST_SIZE,
+            .debug_name = "imported_host_buffer",
+        });
+        if (import_result.is_err())
+        {
+            std::cout << "Skipped host buffer import: " << import_result.message() << std::endl;
+            ::operator delete(host_memory, std::align_val_t{HOST_ALIGNMENT});
+            return;
+        }
+        daxa::BufferId imported_buffer = import_result.value();
+
+        daxa::BufferId staging_readback_buffer = app.device.create_buffer({
+            .memory_flags = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .size = sizeof(std::array<f32, 4>),
+            .debug_name = "staging_readback_buffer",
+        });
+
+        auto cmd_list = app.device.create_command_list({.debug_name = "import_host_buffer command list"});
+        cmd_list.pipeline_barrier({
+            .awaited_pipeline_access = daxa::AccessConsts::HOST_WRITE,
+            .waiting_pipeline_access = daxa::AccessConsts::TRANSFER_READ,
+        });
+        // Copies the last four floats, to make sure the whole allocation was imported.
+        cmd_list.copy_buffer_to_buffer({
+            .src_buffer = imported_buffer,
+            .src_offset = HOST_SIZE - sizeof(std::array<f32, 4>),
+            .dst_buffer = staging_readback_buffer,
+            .size = sizeof(std::array<f32, 4>),
+        });
+        cmd_list.pipeline_barrier({
+            .awaited_pipeline_access = daxa::AccessConsts::TRANSFER_WRITE,
+            .waiting_pipeline_access = daxa::AccessConsts::HOST_READ,
+        });
+        cmd_list.complete();
+
+        app.device.submit_commands({
+            .command_lists = {cmd_list},
+        });
+
+        app.device.wait_idle();
+
+        std::array<f32, 4> readback_data = *app.device.map_memory_as<std::array<f32, 4>>(staging_readback_buffer);
+        app.device.unmap_memory(staging_readback_buffer);
+
+        for (usize i = 0; i < 4; ++i)
+        {
+            DAXA_DBG_ASSERT_TRUE_M(readback_data[i] == host_memory[HOST_SIZE / sizeof(f32) - 4 + i], "readback data differs from imported host memory");
+        }
+
+        app.device.destroy_buffer(imported_buffer);
+        app.device.destroy_buffer(staging_readback_buffer);
+        app.device.wait_idle();
+        app.device.collect_garbage();
+        ::operator delete(host_memory, std::align_val_t{HOST_ALIGNMENT});
+    }
+
     void deferred_destruction(App & app)
     {
         auto cmd_list = app.device.create_command_list({.debug_name = "deferred_destruction command list"});
@@ -219,6 +289,127 @@ namespace tests
         // Collect_garbage loops over all zombie resources and destroyes them when they are no longer used on the gpu/ their assoziated command list finished executng.
         app.device.collect_garbage();
     }
+
+    void reusable_command_list(App & app)
+    {
+        daxa::BufferId buffer = app.device.create_buffer({.size = 4});
+        daxa::BufferId secondary_buffer = app.device.create_buffer({.size = 4});
+        daxa::ImageId image = app.device.create_image({
+            .size = {1, 1, 1},
+            .usage = daxa::ImageUsageFlagBits::COLOR_ATTACHMENT,
+        });
+        daxa::RenderPassBeginInfo const render_pass = {
+            .color_attachments = {{.image_view = image.default_view()}},
+            .render_area = {.x = 0, .y = 0, .width = 1, .height = 1},
+            .secondary_command_lists = true,
+        };
+
+        {
+            auto cmd_list = app.device.create_command_list({.reusable = true, .debug_name = "reusable command list"});
+            auto secondary_cmd_list = app.device.create_secondary_command_list({
+                .render_pass = render_pass,
+                .reusable = true,
+                .debug_name = "reusable secondary command list",
+            });
+            secondary_cmd_list.destroy_buffer_deferred(secondary_buffer);
+            secondary_cmd_list.complete();
+
+            cmd_list.destroy_buffer_deferred(buffer);
+            cmd_list.pipeline_barrier_image_transition({
+                .waiting_pipeline_access = daxa::AccessConsts::COLOR_ATTACHMENT_OUTPUT_WRITE,
+                .before_layout = daxa::ImageLayout::UNDEFINED,
+                .after_layout = daxa::ImageLayout::ATTACHMENT_OPTIMAL,
+                .image_id = image,
+            });
+            cmd_list.begin_renderpass(render_pass);
+            cmd_list.execute_secondary_command_lists(std::array{secondary_cmd_list});
+            cmd_list.end_renderpass();
+            cmd_list.complete();
+
+            // Reusable lists may be submitted again while the previous submission is still pending.
+            app.device.submit_commands({.command_lists = {cmd_list}});
+            app.device.submit_commands({.command_lists = {cmd_list}});
+
+            app.device.wait_idle();
+            app.device.collect_garbage();
+
+            // Deferred destructions of reusable lists only run once the list is released.
+            DAXA_DBG_ASSERT_TRUE_M(app.device.is_id_valid(buffer), "reusable command list destroyed its buffer before it was released");
+            DAXA_DBG_ASSERT_TRUE_M(app.device.is_id_valid(secondary_buffer), "secondary command list destroyed its buffer before it was released");
+        }
+
+        app.device.wait_idle();
+        app.device.collect_garbage();
+
+        // A second destruction would trip the double delete check of the garbage collection.
+        DAXA_DBG_ASSERT_TRUE_M(!app.device.is_id_valid(buffer), "reusable command list did not destroy its buffer after it was released");
+        DAXA_DBG_ASSERT_TRUE_M(!app.device.is_id_valid(secondary_buffer), "secondary command list did not destroy its buffer after it was released");
+
+        app.device.destroy_image(image);
+    }
+
+    void sampler_deduplication(App & app)
+    {
+        // Samplers with identical state share one id, the debug name is ignored.
+        daxa::SamplerId sampler_a = app.device.create_sampler({.debug_name = "sampler a"});
+        daxa::SamplerId sampler_b = app.device.create_sampler({.debug_name = "sampler b"});
+        DAXA_DBG_ASSERT_TRUE_M(sampler_a.index == sampler_b.index && sampler_a.version == sampler_b.version, "identical samplers were not deduplicated");
+
+        // Every create_sampler call is paired with a destroy_sampler call, the sampler lives until the last one.
+        app.device.destroy_sampler(sampler_a);
+        app.device.wait_idle();
+        app.device.collect_garbage();
+        DAXA_DBG_ASSERT_TRUE_M(app.device.is_id_valid(sampler_b), "deduplicated sampler was destroyed while still referenced");
+
+        app.device.destroy_sampler(sampler_b);
+        app.device.wait_idle();
+        app.device.collect_garbage();
+        DAXA_DBG_ASSERT_TRUE_M(!app.device.is_id_valid(sampler_b), "deduplicated sampler was not destroyed after its last reference");
+    }
+
+    void image_view_cache(App & app)
+    {
+        daxa::ImageId image = app.device.create_image({
+            .size = {4, 4, 1},
+            .mip_level_count = 2,
+            .usage = daxa::ImageUsageFlagBits::SHADER_READ_ONLY,
+        });
+        daxa::ImageViewInfo const view_info = {
+            .image = image,
+            .slice = {.base_mip_level = 1, .level_count = 1},
+        };
+
+        daxa::ImageViewId view_a = app.device.cached_image_view(view_info);
+        daxa::ImageViewId view_b = app.device.cached_image_view(view_info);
+        DAXA_DBG_ASSERT_TRUE_M(view_a.index == view_b.index && view_a.version == view_b.version, "identical cached image views were not reused");
+
+        // Cached views are destroyed together with their image.
+        app.device.destroy_image(image);
+        app.device.wait_idle();
+        app.device.collect_garbage();
+        DAXA_DBG_ASSERT_TRUE_M(!app.device.is_id_valid(view_a), "cached image view was not destroyed together with its image");
+    }
+
+    void deferred_callback(App & app)
+    {
+        auto cmd_list = app.device.create_command_list({.debug_name = "deferred_callback command list"});
+        cmd_list.complete();
+
+        app.device.submit_commands({
+            .command_lists = {cmd_list},
+        });
+
+        bool callback_ran = false;
+        // The callback is run by the garbage collection once the gpu passed the given main queue timeline value.
+        app.device.defer_until_retired([&callback_ran]()
+                                       { callback_ran = true; },
+                                       app.device.main_queue_timeline_value());
+
+        app.device.wait_idle();
+        app.device.collect_garbage();
+
+        DAXA_DBG_ASSERT_TRUE_M(callback_ran, "deferred callback was not run after the gpu finished");
+    }
 } // namespace tests
 
 int main()
@@ -226,5 +417,10 @@ int main()
     App app = {};
     tests::simplest(app);
     tests::copy(app);
+    tests::import_host_buffer(app);
     tests::deferred_destruction(app);
+    tests::reusable_command_list(app);
+    tests::deferred_callback(app);
+    tests::sampler_deduplication(app);
+    tests::image_view_cache(app);
 }